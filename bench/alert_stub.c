@@ -0,0 +1,86 @@
+/**
+ * @file alert_stub.c
+ * @brief Webhook local que imprime los eventos de las reglas de alerta, para probarlas sin un receptor real.
+ *
+ * Acepta conexiones en 127.0.0.1, imprime en stdout el cuerpo de cada POST (una línea JSON por
+ * evento) y responde con el código indicado, para probar también el caso de error.
+ *
+ * Uso: alert_stub [puerto] [código]
+ */
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#define DEFAULT_PORT 9099
+#define DEFAULT_STATUS 200
+#define REQUEST_SIZE 4096
+
+/**
+ * @brief Lee una petición completa (encabezados y cuerpo según Content-Length).
+ *
+ * @return Bytes leídos, o -1 en caso de error.
+ */
+static ssize_t read_request(int fd, char* buffer, size_t size)
+{
+    size_t len = 0;
+    while (len < size - 1)
+    {
+        ssize_t n = recv(fd, buffer + len, size - 1 - len, 0);
+        if (n <= 0)
+        {
+            return -1;
+        }
+        len += n;
+        buffer[len] = '\0';
+
+        char* body = strstr(buffer, "\r\n\r\n");
+        const char* length = strcasestr(buffer, "Content-Length:");
+        if (body != NULL && length != NULL && len >= (size_t)(body + 4 - buffer) + strtoul(length + 15, NULL, 10))
+        {
+            return (ssize_t)len;
+        }
+    }
+    return -1;
+}
+
+int main(int argc, char* argv[])
+{
+    int port = argc > 1 ? atoi(argv[1]) : DEFAULT_PORT;
+    int status = argc > 2 ? atoi(argv[2]) : DEFAULT_STATUS;
+
+    int server = socket(AF_INET, SOCK_STREAM, 0);
+    int one = 1;
+    setsockopt(server, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    struct sockaddr_in address = {.sin_family = AF_INET, .sin_port = htons(port)};
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (server < 0 || bind(server, (struct sockaddr*)&address, sizeof(address)) != 0 || listen(server, 16) != 0)
+    {
+        perror("Error al escuchar");
+        return EXIT_FAILURE;
+    }
+    fprintf(stderr, "Esperando eventos en http://127.0.0.1:%d/ (respuesta %d)\n", port, status);
+
+    char request[REQUEST_SIZE], response[128];
+    int response_len = snprintf(response, sizeof(response),
+                                "HTTP/1.1 %d Stub\r\nContent-Length: 0\r\nConnection: close\r\n\r\n", status);
+    while (1)
+    {
+        int fd = accept(server, NULL, NULL);
+        if (fd < 0)
+        {
+            continue;
+        }
+        if (read_request(fd, request, sizeof(request)) > 0)
+        {
+            fputs(strstr(request, "\r\n\r\n") + 4, stdout);
+            fflush(stdout);
+            send(fd, response, response_len, MSG_NOSIGNAL);
+        }
+        close(fd);
+    }
+}
@@ -0,0 +1,126 @@
+/**
+ * @file bench_adaptive.c
+ * @brief Mide la CPU que ahorra el modo adaptativo de los colectores en el host actual.
+ *
+ * Ejecuta los colectores reales sobre /proc en vivo, primero con la frecuencia fija y después con
+ * "adaptive", durante la misma cantidad de ciclos. Informa la CPU del hilo que recolecta, las
+ * ejecuciones de colectores y cuántos ciclos cambiaron la versión de la tabla (es decir,
+ * invalidaron las exposiciones generadas). En un host ocioso la mayoría de los colectores se
+ * espacian hasta max_interval.
+ *
+ * Para no tardar minutos, el ciclo dura period_ms en lugar del intervalo configurado: el
+ * espaciado se cuenta en ciclos, así que el resultado es el mismo que con ciclos de un segundo.
+ *
+ * Uso: bench_adaptive [ciclos] [period_ms] [max_ciclos]
+ */
+
+#include "../include/collectors.h"
+#include "../include/expose_metrics.h"
+#include "../include/proc_source.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define DEFAULT_TICKS 80
+#define DEFAULT_PERIOD_MS 250
+#define DEFAULT_MAX_TICKS 16
+
+/**
+ * @brief Devuelve el tiempo de CPU consumido por el hilo actual en segundos.
+ */
+static double thread_cpu_seconds(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/**
+ * @brief Resultado de una pasada de ciclos.
+ */
+struct pass_result
+{
+    double cpu_seconds;            /**< CPU consumida por los colectores. */
+    unsigned long long runs;       /**< Ejecuciones de colectores. */
+    unsigned long long changes;    /**< Ciclos que cambiaron la versión de la tabla. */
+};
+
+static void run_pass(const struct config* config, int ticks, long period_ms, struct pass_result* result)
+{
+    struct timespec period = {period_ms / 1000, (period_ms % 1000) * 1000000L};
+    *result = (struct pass_result){0};
+
+    for (int tick = 0; tick < ticks; tick++)
+    {
+        proc_source_begin_tick();
+        unsigned long long version = series_version();
+
+        double start = thread_cpu_seconds();
+        int ran = collectors_run(config);
+        if (ran > 0)
+        {
+            update_tick_gauge(0.0, 0.0);
+        }
+        result->cpu_seconds += thread_cpu_seconds() - start;
+        result->runs += ran;
+        result->changes += series_version() != version;
+
+        nanosleep(&period, NULL);
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    int ticks = argc > 1 ? atoi(argv[1]) : DEFAULT_TICKS;
+    long period_ms = argc > 2 ? atol(argv[2]) : DEFAULT_PERIOD_MS;
+    int max_ticks = argc > 3 ? atoi(argv[3]) : DEFAULT_MAX_TICKS;
+    if (ticks <= 0 || period_ms < 0 || max_ticks < 1)
+    {
+        fprintf(stderr, "Uso: %s [ciclos] [period_ms] [max_ciclos]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    if (init_metrics(SERIES_DEFAULT_CAPACITY) != EXIT_SUCCESS)
+    {
+        return EXIT_FAILURE;
+    }
+
+    // Dos configuraciones distintas: collectors_run() reinicia los períodos al cambiar de configuración
+    struct config fixed = {.show_cpu_usage = true,
+                           .show_memory_usage = true,
+                           .show_disk_io = true,
+                           .show_network_stats = true,
+                           .show_process_count = true,
+                           .show_context_switches = true,
+                           .show_socket_stats = true,
+                           .show_numa_stats = true,
+                           .interval = 1,
+                           .max_series = SERIES_DEFAULT_CAPACITY,
+                           .adaptive = false,
+                           .max_interval = max_ticks};
+    struct config adaptive = fixed;
+    adaptive.adaptive = true;
+
+    struct pass_result fixed_result, adaptive_result;
+    run_pass(&fixed, ticks, period_ms, &fixed_result);
+    run_pass(&adaptive, ticks, period_ms, &adaptive_result);
+
+    printf("Ciclos: %d de %ld ms, espaciado máximo: %d ciclos\n\n", ticks, period_ms, max_ticks);
+    printf("%-10s %12s %12s %14s %20s\n", "modo", "CPU (ms)", "us/ciclo", "ejecuciones", "ciclos con cambios");
+    const struct
+    {
+        const char* name;
+        const struct pass_result* result;
+    } rows[] = {{"fijo", &fixed_result}, {"adaptive", &adaptive_result}};
+    for (size_t i = 0; i < sizeof(rows) / sizeof(rows[0]); i++)
+    {
+        printf("%-10s %12.2f %12.1f %14llu %20llu\n", rows[i].name, rows[i].result->cpu_seconds * 1e3,
+               rows[i].result->cpu_seconds / ticks * 1e6, rows[i].result->runs, rows[i].result->changes);
+    }
+
+    if (fixed_result.cpu_seconds > 0)
+    {
+        printf("\nCPU ahorrada: %.1f%%\n", (1.0 - adaptive_result.cpu_seconds / fixed_result.cpu_seconds) * 100.0);
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,171 @@
+/**
+ * @file bench_exposition.c
+ * @brief Compara el costo de generar y el tamaño de los formatos de texto, OpenMetrics y protobuf.
+ *
+ * Llena la tabla de series con familias sintéticas parecidas a las del agente (contadores por
+ * interfaz y gauges por CPU y estado) y genera cada formato repetidas veces sobre el mismo buffer,
+ * como hace el servidor HTTP. Informa el tiempo por exposición, los bytes sin comprimir y con gzip
+ * (Prometheus pide los scrapes comprimidos).
+ *
+ * Uso: bench_exposition [series] [iteraciones]
+ */
+
+#include "../include/series.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <zlib.h>
+
+#define DEFAULT_SERIES 10000
+#define DEFAULT_ITERATIONS 200
+#define LABEL_SIZE 32
+
+/**
+ * @brief Devuelve el tiempo monótono actual en segundos.
+ */
+static double now_seconds(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/**
+ * @brief Devuelve el tamaño de los datos comprimidos con gzip, o 0 en caso de error.
+ */
+static size_t gzip_size(const struct series_buffer* buffer)
+{
+    z_stream stream = {0};
+    if (deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+    {
+        return 0;
+    }
+
+    uLong bound = deflateBound(&stream, buffer->len);
+    unsigned char* out = malloc(bound);
+    if (out == NULL)
+    {
+        deflateEnd(&stream);
+        return 0;
+    }
+
+    stream.next_in = (unsigned char*)buffer->data;
+    stream.avail_in = buffer->len;
+    stream.next_out = out;
+    stream.avail_out = bound;
+    size_t size = deflate(&stream, Z_FINISH) == Z_STREAM_END ? stream.total_out : 0;
+
+    deflateEnd(&stream);
+    free(out);
+    return size;
+}
+
+/**
+ * @brief Crea familias sintéticas y las llena hasta tener aproximadamente series_count series.
+ */
+static int fill_table(size_t series_count)
+{
+    const char* interface_keys[] = {"interface"};
+    const char* core_keys[] = {"cpu", "node", "socket"};
+    const char* state_keys[] = {"state"};
+    int rx = series_family_new("network_interface_rx_bytes_total", "Network RX By Interface", SERIES_COUNTER, 1,
+                               interface_keys);
+    int tx = series_family_new("network_interface_tx_bytes_total", "Network TX By Interface", SERIES_COUNTER, 1,
+                               interface_keys);
+    int cores = series_family_new("cpu_core_usage_percentage", "Porcentaje de uso de CPU por núcleo", SERIES_GAUGE,
+                                  3, core_keys);
+    int sockets = series_family_new("tcp_sockets", "TCP Sockets By State", SERIES_GAUGE, 1, state_keys);
+    if (rx < 0 || tx < 0 || cores < 0 || sockets < 0)
+    {
+        return -1;
+    }
+
+    // Un cuarto de las series son gauges por CPU y el resto contadores por interfaz
+    size_t core_count = series_count / 4;
+    size_t interface_count = (series_count - core_count) / 2;
+
+    for (size_t i = 0; i < interface_count; i++)
+    {
+        char name[LABEL_SIZE];
+        snprintf(name, sizeof(name), "veth%08zx", i * 2654435761u);
+        const char* labels[] = {name};
+        series_set(rx, labels, (double)(i * 1234567));
+        series_set(tx, labels, (double)(i * 7654321));
+    }
+    series_set_exemplar(rx, (const char*[]){"veth00000000"}, "trace_id", "4bf92f3577b34da6a3ce929d0e0e4736", 1500);
+
+    for (size_t i = 0; i < core_count; i++)
+    {
+        char cpu[LABEL_SIZE], node[LABEL_SIZE], socket[LABEL_SIZE];
+        snprintf(cpu, sizeof(cpu), "%zu", i);
+        snprintf(node, sizeof(node), "%zu", i / 64);
+        snprintf(socket, sizeof(socket), "%zu", i / 128);
+        const char* labels[] = {cpu, node, socket};
+        series_set(cores, labels, (i * 37 % 10000) / 100.0);
+    }
+
+    const char* states[] = {"established", "syn_sent", "time_wait", "close_wait", "listen"};
+    for (size_t i = 0; i < sizeof(states) / sizeof(states[0]); i++)
+    {
+        const char* labels[] = {states[i]};
+        series_set(sockets, labels, (double)(i * 100));
+    }
+    return 0;
+}
+
+int main(int argc, char* argv[])
+{
+    size_t series_count = argc > 1 ? strtoul(argv[1], NULL, 10) : DEFAULT_SERIES;
+    int iterations = argc > 2 ? atoi(argv[2]) : DEFAULT_ITERATIONS;
+    if (series_count < 8 || iterations <= 0)
+    {
+        fprintf(stderr, "Uso: %s [series] [iteraciones]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    if (series_table_init(series_count + 16) != 0 || fill_table(series_count) != 0)
+    {
+        fprintf(stderr, "Error al llenar la tabla de series\n");
+        return EXIT_FAILURE;
+    }
+
+    struct series_stats stats;
+    series_get_stats(&stats);
+    printf("Series: %zu, iteraciones: %d\n\n", stats.active, iterations);
+    printf("%-12s %14s %14s %12s %12s\n", "formato", "us/exposición", "ns/serie", "bytes", "bytes gzip");
+
+    static const struct
+    {
+        const char* name;
+        int (*render)(struct series_buffer*, enum series_part);
+    } formats[] = {
+        {"text", series_render_text},
+        {"openmetrics", series_render_openmetrics},
+        {"protobuf", series_render_protobuf},
+    };
+
+    for (size_t f = 0; f < sizeof(formats) / sizeof(formats[0]); f++)
+    {
+        struct series_buffer buffer = {NULL, 0, 0};
+
+        // La primera exposición hace crecer el buffer; las siguientes lo reutilizan
+        if (formats[f].render(&buffer, SERIES_PART_ALL) != 0)
+        {
+            fprintf(stderr, "Error al generar el formato %s\n", formats[f].name);
+            return EXIT_FAILURE;
+        }
+
+        double start = now_seconds();
+        for (int i = 0; i < iterations; i++)
+        {
+            formats[f].render(&buffer, SERIES_PART_ALL);
+        }
+        double elapsed = now_seconds() - start;
+
+        printf("%-12s %14.1f %14.1f %12zu %12zu\n", formats[f].name, elapsed / iterations * 1e6,
+               elapsed / iterations / stats.active * 1e9, buffer.len, gzip_size(&buffer));
+        free(buffer.data);
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,688 @@
+/**
+ * @file bench_scrape.c
+ * @brief Generador de carga de scrapes concurrentes contra el endpoint /metrics del monitor.
+ *
+ * Lanza el monitor reproduciendo una captura de referencia, abre N clientes HTTP keep-alive que
+ * piden /metrics a la tasa indicada y al terminar informa latencias p50/p99/p999, throughput,
+ * CPU y RSS del agente, y el jitter del ciclo de recolección bajo esa carga. El resultado se
+ * agrega como una línea clave=valor al archivo de salida, junto al commit, para poder comparar
+ * corridas entre versiones.
+ *
+ * Uso: bench_scrape [-a agente] [-c config] [-f captura] [-n clientes] [-r tasa] [-d segundos]
+ *                   [-p puerto] [-o salida] [-x]
+ */
+
+#include <arpa/inet.h>
+#include <dirent.h>
+#include <errno.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+#define DEFAULT_AGENT "./metrics"
+#define DEFAULT_CONFIG "bench/fixtures/config.json"
+#define DEFAULT_CAPTURE "bench/fixtures/proc.cap"
+#define DEFAULT_OUTPUT "bench_output.txt"
+#define DEFAULT_PORT 8000
+#define DEFAULT_CLIENTS 16
+#define DEFAULT_DURATION 10
+#define RESPONSE_BUFFER_SIZE (64 * 1024)
+#define BUFFER_SIZE 256
+#define NSEC_PER_SEC 1000000000LL
+
+/**
+ * @brief Parámetros de la corrida.
+ */
+struct bench_options
+{
+    const char* agent;   /**< Binario del monitor. */
+    const char* config;  /**< Configuración del monitor. */
+    const char* capture; /**< Captura reproducida por el monitor. */
+    const char* output;  /**< Archivo donde se agrega el resultado. */
+    int port;            /**< Puerto HTTP del monitor, que se le pasa con --port. */
+    int clients;         /**< Clientes keep-alive concurrentes. */
+    double rate;         /**< Scrapes por segundo por cliente (0 = sin límite). */
+    int duration;        /**< Duración de la medición en segundos. */
+    bool fast_replay;    /**< Reproducir la captura sin esperas para mantener ocupado el mutex. */
+};
+
+/**
+ * @brief Estado de un cliente de carga.
+ */
+struct client
+{
+    pthread_t thread;   /**< Hilo del cliente. */
+    double* latencies;  /**< Latencias medidas en segundos. */
+    size_t count;       /**< Latencias válidas. */
+    size_t capacity;    /**< Latencias reservadas. */
+    size_t errors;      /**< Respuestas fallidas. */
+    size_t bytes;       /**< Bytes de cuerpo recibidos. */
+};
+
+static struct bench_options options = {DEFAULT_AGENT, DEFAULT_CONFIG, DEFAULT_CAPTURE, DEFAULT_OUTPUT,
+                                       DEFAULT_PORT,  DEFAULT_CLIENTS, 0.0,            DEFAULT_DURATION,
+                                       false};
+static volatile bool stop_clients = false;
+
+/**
+ * @brief Devuelve el tiempo monótono actual en segundos.
+ */
+static double now_seconds(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/**
+ * @brief Abre una conexión TCP con el monitor.
+ *
+ * @return Descriptor de la conexión, o -1 en caso de error.
+ */
+static int connect_agent(void)
+{
+    int fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    struct sockaddr_in addr = {.sin_family = AF_INET, .sin_port = htons(options.port)};
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+    if (fd < 0 || connect(fd, (struct sockaddr*)&addr, sizeof(addr)) != 0)
+    {
+        if (fd >= 0)
+        {
+            close(fd);
+        }
+        return -1;
+    }
+
+    int one = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    return fd;
+}
+
+/**
+ * @brief Pide /metrics por una conexión keep-alive y lee la respuesta completa.
+ *
+ * @param fd Conexión con el monitor.
+ * @param buffer Buffer donde se deja la respuesta (encabezados y cuerpo).
+ * @param size Tamaño del buffer.
+ * @return Bytes de cuerpo recibidos, o -1 en caso de error.
+ */
+static long scrape(int fd, char* buffer, size_t size)
+{
+    static const char request[] = "GET /metrics HTTP/1.1\r\nHost: localhost\r\nConnection: keep-alive\r\n\r\n";
+
+    if (send(fd, request, sizeof(request) - 1, MSG_NOSIGNAL) != (ssize_t)(sizeof(request) - 1))
+    {
+        return -1;
+    }
+
+    size_t received = 0;
+    char* body = NULL;
+    long content_length = -1;
+
+    while (1)
+    {
+        if (received == size - 1)
+        {
+            return -1;
+        }
+
+        ssize_t n = recv(fd, buffer + received, size - 1 - received, 0);
+        if (n <= 0)
+        {
+            return -1;
+        }
+        received += n;
+        buffer[received] = '\0';
+
+        if (body == NULL)
+        {
+            char* end = strstr(buffer, "\r\n\r\n");
+            if (end == NULL)
+            {
+                continue;
+            }
+            body = end + 4;
+
+            // Buscar Content-Length entre los encabezados
+            for (char* line = strstr(buffer, "\r\n"); line != NULL && line < end; line = strstr(line + 2, "\r\n"))
+            {
+                if (strncasecmp(line + 2, "Content-Length:", 15) == 0)
+                {
+                    content_length = strtol(line + 17, NULL, 10);
+                    break;
+                }
+            }
+            if (content_length < 0 || strncmp(buffer, "HTTP/1.1 200", 12) != 0)
+            {
+                return -1;
+            }
+        }
+
+        if ((long)(buffer + received - body) >= content_length)
+        {
+            return content_length;
+        }
+    }
+}
+
+/**
+ * @brief Guarda una latencia medida por un cliente.
+ */
+static void record_latency(struct client* client, double latency)
+{
+    if (client->count == client->capacity)
+    {
+        size_t new_capacity = client->capacity == 0 ? 4096 : client->capacity * 2;
+        double* new_latencies = realloc(client->latencies, new_capacity * sizeof(double));
+        if (new_latencies == NULL)
+        {
+            client->errors++;
+            return;
+        }
+        client->latencies = new_latencies;
+        client->capacity = new_capacity;
+    }
+    client->latencies[client->count++] = latency;
+}
+
+/**
+ * @brief Hilo de un cliente: scrapes keep-alive a tasa fija o sin límite hasta que termine la corrida.
+ */
+static void* client_main(void* arg)
+{
+    struct client* client = arg;
+    char* buffer = malloc(RESPONSE_BUFFER_SIZE);
+    int fd = connect_agent();
+    double period = options.rate > 0 ? 1.0 / options.rate : 0.0;
+    double next = now_seconds();
+
+    while (!stop_clients && buffer != NULL)
+    {
+        if (fd < 0)
+        {
+            client->errors++;
+            usleep(10000);
+            fd = connect_agent();
+            continue;
+        }
+
+        double start = now_seconds();
+        long bytes = scrape(fd, buffer, RESPONSE_BUFFER_SIZE);
+        double end = now_seconds();
+
+        if (bytes < 0)
+        {
+            if (!stop_clients)
+            {
+                client->errors++;
+            }
+            close(fd);
+            fd = connect_agent();
+            continue;
+        }
+        record_latency(client, end - start);
+        client->bytes += bytes;
+
+        // Tasa fija: la próxima petición sale en el siguiente múltiplo del período
+        if (period > 0)
+        {
+            next += period;
+            double wait = next - now_seconds();
+            if (wait > 0)
+            {
+                struct timespec ts = {.tv_sec = (time_t)wait, .tv_nsec = (long)((wait - (time_t)wait) * NSEC_PER_SEC)};
+                nanosleep(&ts, NULL);
+            }
+        }
+    }
+
+    if (fd >= 0)
+    {
+        close(fd);
+    }
+    free(buffer);
+    return NULL;
+}
+
+/**
+ * @brief Lee el tiempo de CPU (usuario + sistema) consumido por un proceso, en segundos.
+ */
+static double process_cpu_seconds(pid_t pid)
+{
+    char path[64];
+    char buffer[BUFFER_SIZE * 4];
+    unsigned long utime = 0, stime = 0;
+
+    snprintf(path, sizeof(path), "/proc/%d/stat", (int)pid);
+    FILE* fp = fopen(path, "r");
+    if (fp == NULL)
+    {
+        return 0.0;
+    }
+    if (fgets(buffer, sizeof(buffer), fp) != NULL)
+    {
+        // El nombre del proceso puede contener espacios: los campos empiezan después del último ')'
+        char* fields = strrchr(buffer, ')');
+        if (fields != NULL)
+        {
+            sscanf(fields + 2, "%*c %*d %*d %*d %*d %*d %*u %*u %*u %*u %*u %lu %lu", &utime, &stime);
+        }
+    }
+    fclose(fp);
+    return (double)(utime + stime) / sysconf(_SC_CLK_TCK);
+}
+
+/**
+ * @brief Lee la memoria residente de un proceso, en KiB.
+ */
+static long process_rss_kb(pid_t pid)
+{
+    char path[64];
+    char buffer[BUFFER_SIZE];
+    long rss = 0;
+
+    snprintf(path, sizeof(path), "/proc/%d/status", (int)pid);
+    FILE* fp = fopen(path, "r");
+    if (fp == NULL)
+    {
+        return 0;
+    }
+    while (fgets(buffer, sizeof(buffer), fp) != NULL)
+    {
+        if (sscanf(buffer, "VmRSS: %ld kB", &rss) == 1)
+        {
+            break;
+        }
+    }
+    fclose(fp);
+    return rss;
+}
+
+/**
+ * @brief Lee el valor de una métrica sin etiquetas de una respuesta de /metrics.
+ *
+ * @return Valor de la métrica, o -1.0 si no aparece.
+ */
+static double find_metric(const char* response, const char* name)
+{
+    size_t name_len = strlen(name);
+    for (const char* line = response; line != NULL; line = strchr(line, '\n'))
+    {
+        if (*line == '\n')
+        {
+            line++;
+        }
+        if (strncmp(line, name, name_len) == 0 && line[name_len] == ' ')
+        {
+            return strtod(line + name_len + 1, NULL);
+        }
+    }
+    return -1.0;
+}
+
+static int compare_double(const void* a, const void* b)
+{
+    double x = *(const double*)a;
+    double y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+/**
+ * @brief Devuelve el percentil p (0 a 1) de un arreglo ordenado.
+ */
+static double percentile(const double* sorted, size_t count, double p)
+{
+    if (count == 0)
+    {
+        return 0.0;
+    }
+    size_t index = (size_t)(p * (count - 1) + 0.5);
+    return sorted[index < count ? index : count - 1];
+}
+
+/**
+ * @brief Lanza el monitor reproduciendo la captura de referencia en bucle.
+ *
+ * @return PID del monitor, o -1 en caso de error.
+ */
+static pid_t start_agent(void)
+{
+    char port[BUFFER_SIZE];
+    snprintf(port, sizeof(port), "%d", options.port);
+
+    pid_t pid = fork();
+    if (pid == 0)
+    {
+        if (options.fast_replay)
+        {
+            execl(options.agent, options.agent, options.config, "--port", port, "--replay", options.capture, "--loop",
+                  "--fast", (char*)NULL);
+        }
+        else
+        {
+            execl(options.agent, options.agent, options.config, "--port", port, "--replay", options.capture, "--loop",
+                  (char*)NULL);
+        }
+        perror("Error al ejecutar el monitor");
+        _exit(127);
+    }
+    return pid;
+}
+
+/**
+ * @brief Busca el inodo del socket que escucha en el puerto del monitor.
+ *
+ * @return Inodo del socket en LISTEN, o 0 si no hay ninguno.
+ */
+static unsigned long listening_inode(void)
+{
+    static const char* const tables[] = {"/proc/net/tcp", "/proc/net/tcp6"};
+    char line[BUFFER_SIZE];
+
+    for (size_t t = 0; t < sizeof(tables) / sizeof(tables[0]); t++)
+    {
+        FILE* fp = fopen(tables[t], "r");
+        if (fp == NULL)
+        {
+            continue;
+        }
+        while (fgets(line, sizeof(line), fp) != NULL)
+        {
+            unsigned int port, state;
+            unsigned long inode;
+            if (sscanf(line, " %*d: %*[0-9A-Fa-f]:%X %*[0-9A-Fa-f]:%*X %X %*X:%*X %*X:%*X %*X %*u %*u %lu", &port,
+                       &state, &inode) == 3 &&
+                (int)port == options.port && state == TCP_LISTEN)
+            {
+                fclose(fp);
+                return inode;
+            }
+        }
+        fclose(fp);
+    }
+    return 0;
+}
+
+/**
+ * @brief Indica si un proceso tiene abierto el socket con el inodo dado.
+ */
+static bool process_has_socket(pid_t pid, unsigned long inode)
+{
+    char path[BUFFER_SIZE], link[BUFFER_SIZE], expected[BUFFER_SIZE];
+    snprintf(path, sizeof(path), "/proc/%d/fd", (int)pid);
+    snprintf(expected, sizeof(expected), "socket:[%lu]", inode);
+
+    DIR* dir = opendir(path);
+    if (dir == NULL)
+    {
+        return false;
+    }
+    bool found = false;
+    struct dirent* entry;
+    while (!found && (entry = readdir(dir)) != NULL)
+    {
+        char fd_path[2 * BUFFER_SIZE];
+        snprintf(fd_path, sizeof(fd_path), "%s/%s", path, entry->d_name);
+        ssize_t len = readlink(fd_path, link, sizeof(link) - 1);
+        if (len > 0)
+        {
+            link[len] = '\0';
+            found = strcmp(link, expected) == 0;
+        }
+    }
+    closedir(dir);
+    return found;
+}
+
+/**
+ * @brief Espera a que el monitor acepte conexiones en su puerto.
+ *
+ * Comprueba que el monitor lanzado siga vivo y que sea él quien escucha en el puerto: de lo
+ * contrario se medirían la latencia de otro proceso y la CPU y RSS del monitor.
+ *
+ * @return 0 si el monitor atiende en su puerto, o -1 en caso de error.
+ */
+static int wait_for_agent(pid_t pid)
+{
+    for (int attempt = 0; attempt < 100; attempt++)
+    {
+        if (waitpid(pid, NULL, WNOHANG) == pid)
+        {
+            fprintf(stderr, "El monitor terminó antes de aceptar conexiones\n");
+            return -1;
+        }
+        int fd = connect_agent();
+        if (fd >= 0)
+        {
+            close(fd);
+            unsigned long inode = listening_inode();
+            if (inode == 0 || !process_has_socket(pid, inode))
+            {
+                fprintf(stderr, "El puerto %d no lo atiende el monitor lanzado (PID %d)\n", options.port, (int)pid);
+                return -1;
+            }
+            return 0;
+        }
+        usleep(50000);
+    }
+    fprintf(stderr, "El monitor no aceptó conexiones en el puerto %d\n", options.port);
+    return -1;
+}
+
+/**
+ * @brief Detiene el monitor: le pide terminar con SIGINT y, si no terminó, lo mata y lo recoge.
+ */
+static void stop_agent(pid_t pid)
+{
+    kill(pid, SIGINT);
+    usleep(100000);
+    kill(pid, SIGKILL);
+    waitpid(pid, NULL, 0);
+}
+
+/**
+ * @brief Devuelve el commit actual, para identificar la corrida.
+ */
+static void current_commit(char* commit, size_t size)
+{
+    snprintf(commit, size, "unknown");
+    FILE* fp = popen("git rev-parse --short HEAD 2>/dev/null", "r");
+    if (fp == NULL)
+    {
+        return;
+    }
+    if (fgets(commit, size, fp) != NULL)
+    {
+        commit[strcspn(commit, "\n")] = '\0';
+    }
+    pclose(fp);
+}
+
+static void usage(const char* program)
+{
+    fprintf(stderr,
+            "Uso: %s [-a agente] [-c config] [-f captura] [-n clientes] [-r tasa] [-d segundos] [-p puerto] "
+            "[-o salida] [-x]\n",
+            program);
+}
+
+int main(int argc, char* argv[])
+{
+    int opt;
+    while ((opt = getopt(argc, argv, "a:c:f:n:r:d:p:o:x")) != -1)
+    {
+        switch (opt)
+        {
+        case 'a':
+            options.agent = optarg;
+            break;
+        case 'c':
+            options.config = optarg;
+            break;
+        case 'f':
+            options.capture = optarg;
+            break;
+        case 'n':
+            options.clients = atoi(optarg);
+            break;
+        case 'r':
+            options.rate = atof(optarg);
+            break;
+        case 'd':
+            options.duration = atoi(optarg);
+            break;
+        case 'p':
+            options.port = atoi(optarg);
+            break;
+        case 'o':
+            options.output = optarg;
+            break;
+        case 'x':
+            options.fast_replay = true;
+            break;
+        default:
+            usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+    if (options.clients <= 0 || options.duration <= 0)
+    {
+        usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    // Si otro proceso ya escucha en el puerto, el monitor no podría usarlo
+    int busy = connect_agent();
+    if (busy >= 0)
+    {
+        close(busy);
+        fprintf(stderr, "El puerto %d ya está en uso\n", options.port);
+        return EXIT_FAILURE;
+    }
+
+    pid_t agent = start_agent();
+    if (agent < 0)
+    {
+        perror("Error al lanzar el monitor");
+        return EXIT_FAILURE;
+    }
+    if (wait_for_agent(agent) != 0)
+    {
+        stop_agent(agent);
+        return EXIT_FAILURE;
+    }
+
+    struct client* clients = calloc(options.clients, sizeof(struct client));
+    if (clients == NULL)
+    {
+        perror("Error al reservar memoria");
+        stop_agent(agent);
+        return EXIT_FAILURE;
+    }
+
+    double cpu_start = process_cpu_seconds(agent);
+    double start = now_seconds();
+    for (int i = 0; i < options.clients; i++)
+    {
+        pthread_create(&clients[i].thread, NULL, client_main, &clients[i]);
+    }
+
+    // Mientras tanto, muestrear RSS y jitter del colector una vez por segundo por una conexión aparte
+    char* sample = malloc(RESPONSE_BUFFER_SIZE);
+    int sample_fd = connect_agent();
+    long rss_max = 0;
+    double jitter_sum = 0.0, jitter_max = 0.0, tick_max = 0.0;
+    int jitter_samples = 0;
+    for (int second = 0; second < options.duration; second++)
+    {
+        sleep(1);
+        long rss = process_rss_kb(agent);
+        rss_max = rss > rss_max ? rss : rss_max;
+
+        if (sample != NULL && sample_fd >= 0 && scrape(sample_fd, sample, RESPONSE_BUFFER_SIZE) >= 0)
+        {
+            double jitter = find_metric(sample, "collector_tick_jitter_seconds");
+            double tick = find_metric(sample, "collector_tick_duration_seconds");
+            if (jitter >= 0)
+            {
+                jitter_sum += jitter;
+                jitter_max = jitter > jitter_max ? jitter : jitter_max;
+                jitter_samples++;
+            }
+            tick_max = tick > tick_max ? tick : tick_max;
+        }
+    }
+
+    stop_clients = true;
+    double elapsed = now_seconds() - start;
+    double cpu = process_cpu_seconds(agent) - cpu_start;
+    for (int i = 0; i < options.clients; i++)
+    {
+        pthread_join(clients[i].thread, NULL);
+    }
+    stop_agent(agent);
+
+    size_t total = 0, errors = 0, bytes = 0;
+    for (int i = 0; i < options.clients; i++)
+    {
+        total += clients[i].count;
+        errors += clients[i].errors;
+        bytes += clients[i].bytes;
+    }
+    double* latencies = malloc((total > 0 ? total : 1) * sizeof(double));
+    size_t offset = 0;
+    for (int i = 0; i < options.clients && latencies != NULL; i++)
+    {
+        memcpy(latencies + offset, clients[i].latencies, clients[i].count * sizeof(double));
+        offset += clients[i].count;
+        free(clients[i].latencies);
+    }
+    if (latencies == NULL)
+    {
+        perror("Error al reservar memoria");
+        return EXIT_FAILURE;
+    }
+    qsort(latencies, total, sizeof(double), compare_double);
+
+    char commit[64];
+    current_commit(commit, sizeof(commit));
+
+    char result[BUFFER_SIZE * 4];
+    snprintf(result, sizeof(result),
+             "commit=%s clients=%d rate=%.1f fast_replay=%d duration=%.1f scrapes=%zu errors=%zu "
+             "throughput=%.1f body_bytes=%zu p50_ms=%.3f p99_ms=%.3f p999_ms=%.3f agent_cpu_pct=%.1f "
+             "agent_rss_kb=%ld tick_jitter_avg_ms=%.3f tick_jitter_max_ms=%.3f tick_duration_max_ms=%.3f",
+             commit, options.clients, options.rate, options.fast_replay, elapsed, total, errors, total / elapsed,
+             total > 0 ? bytes / total : 0, percentile(latencies, total, 0.50) * 1e3,
+             percentile(latencies, total, 0.99) * 1e3, percentile(latencies, total, 0.999) * 1e3,
+             cpu / elapsed * 100.0, rss_max, jitter_samples > 0 ? jitter_sum / jitter_samples * 1e3 : 0.0,
+             jitter_max * 1e3, tick_max * 1e3);
+    printf("%s\n", result);
+
+    FILE* out = fopen(options.output, "a");
+    if (out != NULL)
+    {
+        fprintf(out, "bench_scrape %s\n", result);
+        fclose(out);
+    }
+
+    if (sample_fd >= 0)
+    {
+        close(sample_fd);
+    }
+    free(sample);
+    free(latencies);
+    free(clients);
+    return errors == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
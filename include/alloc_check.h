@@ -0,0 +1,50 @@
+/**
+ * @file alloc_check.h
+ * @brief Conteo de reservas de memoria, para verificar que los ciclos y los scrapes no usan el heap.
+ *
+ * Sólo está disponible al compilar con -DALLOC_CHECK (objetivo "make alloc-check"): en ese caso
+ * alloc_check.c reemplaza malloc(), calloc() y realloc() de glibc por versiones que cuentan las
+ * llamadas del hilo actual, incluidas las que hace la propia libc (p. ej. fopen()), y además las
+ * reservas y los bytes de todo el proceso, para medir el hilo del servidor HTTP.
+ */
+
+#include <stddef.h>
+
+#ifndef ALLOC_CHECK_H
+#define ALLOC_CHECK_H
+
+#ifdef ALLOC_CHECK
+
+/**
+ * @brief Ciclos iniciales en los que se permite reservar memoria mientras los buffers alcanzan su tamaño.
+ */
+#define ALLOC_CHECK_WARMUP_TICKS 2
+
+/**
+ * @brief Devuelve la cantidad de reservas hechas por el hilo actual desde que comenzó.
+ */
+unsigned long long alloc_check_count(void);
+
+/**
+ * @brief Bytes que puede reservar un scrape: la respuesta de MHD y sus encabezados, nunca una copia
+ * de la exposición.
+ */
+#define ALLOC_CHECK_SCRAPE_MAX_BYTES 4096
+
+/**
+ * @brief Hace un scrape real de /metrics y mide lo que reservó todo el proceso mientras se atendía.
+ *
+ * Usa una única conexión keep-alive al servidor local, que abre en la primera llamada.
+ *
+ * @param port Puerto del servidor HTTP.
+ * @param scrape_allocations Reservas hechas durante el scrape.
+ * @param scrape_bytes Bytes pedidos en esas reservas.
+ * @param body_len Tamaño de la exposición recibida.
+ * @return 0 en caso de éxito, o -1 en caso de error.
+ */
+int alloc_check_scrape(int port, unsigned long long* scrape_allocations, unsigned long long* scrape_bytes,
+                       size_t* body_len);
+
+#endif // ALLOC_CHECK
+
+#endif // ALLOC_CHECK_H
@@ -0,0 +1,60 @@
+/**
+ * @file arena.h
+ * @brief Arena de memoria de tamaño fijo: reservas por desplazamiento y liberación en bloque.
+ *
+ * Se reserva una sola vez al iniciar; arena_alloc() sólo avanza un puntero y arena_reset() libera
+ * todo lo reservado de una vez. Así, las tareas repetidas (como volver a leer la configuración)
+ * no usan el heap después del arranque.
+ */
+
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/**
+ * @brief Arena de memoria.
+ */
+struct arena
+{
+    char* base;      /**< Bloque reservado en arena_init(). */
+    size_t capacity; /**< Tamaño del bloque en bytes. */
+    size_t used;     /**< Bytes ocupados desde el último arena_reset(). */
+    size_t peak;     /**< Máximo de bytes ocupados desde arena_init(). */
+    bool exhausted;  /**< Indica si alguna reserva falló por falta de lugar desde el último arena_reset(). */
+};
+
+/**
+ * @brief Reserva el bloque de la arena.
+ *
+ * @param arena Arena a inicializar.
+ * @param capacity Tamaño del bloque en bytes.
+ * @return 0 en caso de éxito, o -1 si no se pudo reservar memoria.
+ */
+int arena_init(struct arena* arena, size_t capacity);
+
+/**
+ * @brief Reserva memoria alineada dentro de la arena.
+ *
+ * @param arena Arena de la que se reserva.
+ * @param size Cantidad de bytes.
+ * @return Puntero a la memoria, o NULL si la arena no tiene lugar (y queda marcada como agotada).
+ */
+void* arena_alloc(struct arena* arena, size_t size);
+
+/**
+ * @brief Libera todo lo reservado en la arena, sin devolver el bloque al sistema.
+ *
+ * @param arena Arena a vaciar.
+ */
+void arena_reset(struct arena* arena);
+
+/**
+ * @brief Devuelve el bloque de la arena al sistema.
+ *
+ * @param arena Arena a destruir.
+ */
+void arena_destroy(struct arena* arena);
+
+#endif // ARENA_H
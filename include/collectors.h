@@ -0,0 +1,28 @@
+/**
+ * @file collectors.h
+ * @brief Tabla de colectores y su frecuencia adaptativa.
+ *
+ * Cada ciclo del planificador ejecuta los colectores activos en la configuración. Con "adaptive",
+ * un colector cuyas series no cambiaron (según series_version()) duplica la cantidad de ciclos
+ * hasta su próxima ejecución, hasta max_interval; en cuanto alguna de sus series cambia vuelve a
+ * ejecutarse en cada ciclo. Al publicarse otra configuración todos vuelven a ejecutarse en el
+ * ciclo siguiente.
+ *
+ * El espaciado se cuenta en ciclos y no en segundos, de modo que funciona igual en vivo y al
+ * reproducir una captura.
+ */
+
+#ifndef COLLECTORS_H
+#define COLLECTORS_H
+
+#include "config.h"
+
+/**
+ * @brief Ejecuta los colectores activos a los que les toca este ciclo.
+ *
+ * @param config Configuración del ciclo, tomada con config_acquire().
+ * @return Cantidad de colectores ejecutados.
+ */
+int collectors_run(const struct config* config);
+
+#endif // COLLECTORS_H
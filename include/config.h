@@ -0,0 +1,145 @@
+/**
+ * @file config.h
+ * @brief Configuración inmutable publicada con un intercambio atómico de punteros y recarga en caliente.
+ *
+ * Cada lectura del archivo JSON produce una struct config nueva que nunca se modifica después de
+ * publicarse. El hilo de recarga la escribe en un lugar libre de un conjunto fijo y la publica con
+ * un único store atómico; el planificador la toma con config_acquire() al comenzar cada ciclo, de
+ * modo que un ciclo siempre ve una configuración completa y nunca una a medio aplicar.
+ *
+ * La recarga se dispara al guardar el archivo (inotify sobre su directorio, para seguir también a
+ * los editores que lo reemplazan con rename()) o al recibir SIGUSR1 (signalfd). Tras publicar, el
+ * hilo de recarga escribe en config_wake_fd() para despertar al planificador.
+ *
+ * La configuración anterior no se reutiliza mientras el planificador la tenga tomada: con un
+ * único lector basta un hazard pointer, y con CONFIG_SLOTS lugares siempre queda uno libre.
+ */
+
+#ifndef CONFIG_H
+#define CONFIG_H
+
+#include "series.h"
+#include <stdbool.h>
+#include <stddef.h>
+
+/**
+ * @brief Lugares para configuraciones: la publicada, la que usa el planificador y la que se escribe.
+ */
+#define CONFIG_SLOTS 3
+
+/**
+ * @brief Tamaño de la arena donde se leen y analizan los archivos de configuración.
+ */
+#define CONFIG_ARENA_SIZE (64 * 1024)
+
+/**
+ * @brief Cantidad máxima de reglas de alerta.
+ */
+#define CONFIG_MAX_RULES 32
+
+/**
+ * @brief Tamaño máximo (incluyendo el terminador) del nombre de una regla.
+ */
+#define CONFIG_RULE_NAME_SIZE 64
+
+/**
+ * @brief Tamaño máximo (incluyendo el terminador) del nombre de la métrica de una regla.
+ */
+#define CONFIG_RULE_METRIC_SIZE 128
+
+/**
+ * @brief Tamaño máximo (incluyendo el terminador) de la URL del webhook o del comando de una regla.
+ */
+#define CONFIG_RULE_ACTION_SIZE 256
+
+/**
+ * @brief Comparación entre el valor observado y el umbral de una regla.
+ */
+enum rule_op
+{
+    RULE_GT, /**< ">" */
+    RULE_GE, /**< ">=" */
+    RULE_LT, /**< "<" */
+    RULE_LE, /**< "<=" */
+    RULE_EQ, /**< "==" */
+    RULE_NE  /**< "!=" */
+};
+
+/**
+ * @brief Regla de alerta sobre una serie, tal como se lee de "rules".
+ */
+struct rule_config
+{
+    char name[CONFIG_RULE_NAME_SIZE];                        /**< Nombre de la regla ("name"). */
+    char metric[CONFIG_RULE_METRIC_SIZE];                    /**< Familia observada ("metric"). */
+    size_t label_count;                                      /**< Cantidad de etiquetas en "labels". */
+    char label_keys[SERIES_MAX_LABELS][SERIES_LABEL_SIZE];   /**< Nombres de las etiquetas de la serie. */
+    char label_values[SERIES_MAX_LABELS][SERIES_LABEL_SIZE]; /**< Valores de las etiquetas de la serie. */
+    enum rule_op op;                                         /**< Comparación ("op", ">" por defecto). */
+    double threshold;                                        /**< Umbral ("threshold"). */
+    double rate_window;                                      /**< Ventana de la tasa en segundos ("rate"); 0 = valor. */
+    double for_seconds;                                      /**< Tiempo que debe cumplirse antes de disparar ("for"). */
+    char webhook[CONFIG_RULE_ACTION_SIZE];                   /**< URL http:// a la que se envía un POST ("webhook"). */
+    char exec[CONFIG_RULE_ACTION_SIZE];                      /**< Programa a ejecutar ("exec"). */
+};
+
+/**
+ * @brief Configuración del monitor; inmutable una vez publicada.
+ */
+struct config
+{
+    bool show_cpu_usage;        /**< Métrica de uso de CPU ("cpu"). */
+    bool show_memory_usage;     /**< Métricas de memoria ("memory"). */
+    bool show_disk_io;          /**< Métricas de I/O de disco ("disk_io"). */
+    bool show_network_stats;    /**< Estadísticas de red ("network_stats"). */
+    bool show_process_count;    /**< Conteo de procesos ("process_count"). */
+    bool show_context_switches; /**< Cambios de contexto ("context_switches"). */
+    bool show_socket_stats;     /**< Estadísticas de sockets TCP/UDP ("socket_stats"). */
+    bool show_numa_stats;       /**< Estadísticas de los nodos NUMA ("numa"). */
+    int interval;               /**< Intervalo entre ciclos de recolección, en segundos. */
+    size_t max_series;          /**< Cantidad máxima de series; sólo se aplica al iniciar. */
+    bool adaptive;              /**< Espaciar los colectores cuyos valores no cambian ("adaptive"). */
+    int max_interval;           /**< Intervalo máximo de un colector espaciado, en segundos. */
+    bool profile;               /**< Perfilar los colectores y los scrapes en /debug/profile ("profile"). */
+    size_t rule_count;          /**< Cantidad de reglas de alerta. */
+    struct rule_config rules[CONFIG_MAX_RULES]; /**< Reglas de alerta ("rules"). */
+};
+
+/**
+ * @brief Lee y publica la configuración inicial.
+ *
+ * Si el archivo no existe o es inválido se publica la configuración por defecto (todas las
+ * métricas cada 5 segundos).
+ *
+ * @param path Ruta del archivo de configuración.
+ * @return 0 en caso de éxito, o -1 si no se pudieron reservar los recursos.
+ */
+int config_init(const char* path);
+
+/**
+ * @brief Inicia el hilo que recarga la configuración al cambiar el archivo o al recibir SIGUSR1.
+ *
+ * SIGUSR1 debe estar bloqueada en todos los hilos antes de llamarla.
+ *
+ * @return 0 en caso de éxito, o -1 en caso de error.
+ */
+int config_watch(void);
+
+/**
+ * @brief Toma la configuración publicada más reciente.
+ *
+ * Sólo debe llamarla el planificador. La configuración devuelta sigue siendo válida hasta la
+ * próxima llamada, aunque entretanto se publique otra.
+ *
+ * @return Configuración actual.
+ */
+const struct config* config_acquire(void);
+
+/**
+ * @brief Devuelve un descriptor que queda legible cuando se publica una configuración nueva.
+ *
+ * config_acquire() lo vuelve a dejar sin datos.
+ */
+int config_wake_fd(void);
+
+#endif // CONFIG_H
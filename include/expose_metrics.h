@@ -4,10 +4,14 @@
  */
 
 #include "metrics.h"
+#include "numa.h"
+#include "rules.h"
+#include "self_profile.h"
+#include "series.h"
+#include "sock_diag.h"
 // #include "read_cpu_usage.h"
 #include <errno.h>
-#include <prom.h>
-#include <promhttp.h>
+#include <microhttpd.h>
 #include <pthread.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -20,9 +24,16 @@
 #define BUFFER_SIZE 256
 
 /**
- * @brief Actualiza la métrica de uso de CPU.
+ * @brief Puerto en el que el servidor HTTP expone /metrics, salvo que se indique otro con --port.
  */
-void update_cpu_gauge();
+#define HTTP_PORT 8000
+
+/**
+ * @brief Actualiza la métrica de uso de CPU, total y por núcleo (con su nodo NUMA y socket).
+ *
+ * @param per_core Publicar también el uso por núcleo, que requiere la topología NUMA.
+ */
+void update_cpu_gauge(bool per_core);
 
 /**
  * @brief Actualiza la métrica de uso de memoria.
@@ -35,12 +46,12 @@ void update_memory_gauge();
 void update_memory_gauge2();
 
 /**
- * @brief Actualiza la métrica de I/O de disco.
+ * @brief Actualiza las métricas de I/O de disco, totales y por dispositivo.
  */
 void update_disk_io_gauge();
 
 /**
- * @brief Actualiza la métrica de estadísticas de red.
+ * @brief Actualiza las métricas de estadísticas de red, totales y por interfaz.
  */
 void update_network_gauge();
 
@@ -55,17 +66,54 @@ void update_process_count_gauge();
 void update_context_switches_gauge();
 
 /**
- * @brief Función del hilo para exponer las métricas vía HTTP en el puerto 8000.
- * @param arg Argumento no utilizado.
+ * @brief Actualiza las métricas de sockets TCP/UDP (contadores de /proc/net/snmp e histograma INET_DIAG).
+ */
+void update_socket_stats_gauge();
+
+/**
+ * @brief Actualiza las métricas de memoria y asignaciones (numastat) de cada nodo NUMA.
+ */
+void update_numa_gauge();
+
+/**
+ * @brief Actualiza las métricas propias del ciclo de recolección y de la tabla de series.
+ *
+ * @param duration Segundos que tardó el último ciclo en recolectar y publicar las métricas.
+ * @param jitter Segundos de retraso del comienzo del ciclo respecto del momento previsto.
+ */
+void update_tick_gauge(double duration, double jitter);
+
+/**
+ * @brief Actualiza el estado de las reglas de alerta y los contadores de sus acciones.
+ */
+void update_rules_gauge();
+
+/**
+ * @brief Actualiza el intervalo actual y la cantidad de ejecuciones de un colector.
+ *
+ * @param collector Nombre del colector.
+ * @param interval Segundos hasta su próxima ejecución.
+ * @param runs Ejecuciones desde el arranque.
+ */
+void update_collector_gauge(const char* collector, double interval, unsigned long long runs);
+
+/**
+ * @brief Función del hilo para exponer las métricas vía HTTP.
+ *
+ * Además de /metrics atiende /debug/profile con el perfil del agente (ver self_profile.h). Si no
+ * puede escuchar en el puerto (p. ej. porque otro proceso ya lo usa), termina el programa: un
+ * agente sin servidor HTTP no expone nada.
+ * @param arg Puntero a un int con el puerto, que debe seguir siendo válido mientras dure el hilo.
  * @return NULL
  */
 void* expose_metrics(void* arg);
 
 /**
- * @brief Inicializa el mutex y las métricas.
+ * @brief Inicializa el mutex, la tabla de series y las métricas.
+ * @param max_series Cantidad máxima de series de la tabla.
  * @return EXIT_SUCCESS si la inicialización es exitosa, de lo contrario EXIT_FAILURE.
  */
-int init_metrics();
+int init_metrics(size_t max_series);
 
 /**
  * @brief Destruye el mutex.
@@ -3,6 +3,10 @@
  * @brief Funciones para obtener el uso de CPU y memoria desde el sistema de archivos /proc.
  */
 
+#ifndef METRICS_H
+#define METRICS_H
+
+#include "numa.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -27,11 +31,15 @@ double get_memory_usage();
  * @brief Obtiene el porcentaje de uso de CPU desde /proc/stat.
  *
  * Lee los tiempos de CPU desde /proc/stat y calcula el porcentaje de uso de CPU
- * en un intervalo de tiempo.
+ * en un intervalo de tiempo. Si se pide, calcula también el uso de cada núcleo con
+ * get_cpu_core_usage() a partir de la misma lectura.
  *
+ * @param cores Arreglo donde se guarda el uso de cada CPU, o NULL para calcular sólo el total.
+ * @param max_cores Capacidad de cores.
+ * @param core_count Cantidad de CPUs guardadas en cores, o -1 si no se pudo calcular.
  * @return Uso de CPU como porcentaje (0.0 a 100.0), o -1.0 en caso de error.
  */
-double get_cpu_usage();
+double get_cpu_usage(struct cpu_core_usage* cores, int max_cores, int* core_count);
 
 /**
  * @brief Obtiene las estadísticas de uso de memoria desde /proc/meminfo.
@@ -64,6 +72,49 @@ void get_disk_io_stats(unsigned long long* reads, unsigned long long* writes);
  */
 void get_network_stats(unsigned long long* rx_bytes, unsigned long long* tx_bytes);
 
+/**
+ * @brief Tamaño máximo (incluyendo el terminador) del nombre de una interfaz o dispositivo.
+ */
+#define DEVICE_NAME_SIZE 32
+
+/**
+ * @brief Bytes recibidos y transmitidos por una interfaz de red.
+ */
+struct net_interface_stats
+{
+    char name[DEVICE_NAME_SIZE]; /**< Nombre de la interfaz. */
+    unsigned long long rx_bytes; /**< Bytes recibidos. */
+    unsigned long long tx_bytes; /**< Bytes transmitidos. */
+};
+
+/**
+ * @brief Obtiene los bytes recibidos y transmitidos por cada interfaz desde /proc/net/dev.
+ *
+ * @param interfaces Arreglo donde se guardan las estadísticas.
+ * @param max_interfaces Capacidad del arreglo; las interfaces sobrantes se ignoran.
+ * @return Cantidad de interfaces leídas, o -1 en caso de error.
+ */
+int get_network_interface_stats(struct net_interface_stats* interfaces, int max_interfaces);
+
+/**
+ * @brief Sectores leídos y escritos por un dispositivo de bloques.
+ */
+struct disk_device_stats
+{
+    char name[DEVICE_NAME_SIZE];      /**< Nombre del dispositivo. */
+    unsigned long long read_sectors;  /**< Sectores leídos. */
+    unsigned long long write_sectors; /**< Sectores escritos. */
+};
+
+/**
+ * @brief Obtiene los sectores leídos y escritos por cada dispositivo desde /proc/diskstats.
+ *
+ * @param devices Arreglo donde se guardan las estadísticas.
+ * @param max_devices Capacidad del arreglo; los dispositivos sobrantes se ignoran.
+ * @return Cantidad de dispositivos leídos, o -1 en caso de error.
+ */
+int get_disk_device_stats(struct disk_device_stats* devices, int max_devices);
+
 /**
  * @brief Obtiene el número de procesos en ejecución desde /proc/stat.
  *
@@ -80,4 +131,45 @@ int get_process_count();
  *
  * @return Número de cambios de contexto, o 0 en caso de error.
  */
-unsigned long long get_context_switches();
\ No newline at end of file
+unsigned long long get_context_switches();
+
+/**
+ * @brief Contadores de protocolo TCP/UDP leídos desde /proc/net/snmp y /proc/net/netstat.
+ */
+struct net_proto_stats
+{
+    unsigned long long tcp_active_opens;     /**< Conexiones TCP abiertas activamente (Tcp: ActiveOpens). */
+    unsigned long long tcp_passive_opens;    /**< Conexiones TCP aceptadas (Tcp: PassiveOpens). */
+    unsigned long long tcp_attempt_fails;    /**< Intentos de conexión fallidos (Tcp: AttemptFails). */
+    unsigned long long tcp_estab_resets;     /**< Conexiones establecidas reiniciadas (Tcp: EstabResets). */
+    unsigned long long tcp_curr_estab;       /**< Conexiones actualmente establecidas (Tcp: CurrEstab). */
+    unsigned long long tcp_in_segs;          /**< Segmentos recibidos (Tcp: InSegs). */
+    unsigned long long tcp_out_segs;         /**< Segmentos enviados (Tcp: OutSegs). */
+    unsigned long long tcp_retrans_segs;     /**< Segmentos retransmitidos (Tcp: RetransSegs). */
+    unsigned long long tcp_in_errs;          /**< Segmentos recibidos con error (Tcp: InErrs). */
+    unsigned long long tcp_out_rsts;         /**< Segmentos RST enviados (Tcp: OutRsts). */
+    unsigned long long tcp_listen_overflows; /**< Desbordes de la cola de escucha (TcpExt: ListenOverflows). */
+    unsigned long long tcp_listen_drops;     /**< SYN descartados en sockets en escucha (TcpExt: ListenDrops). */
+    unsigned long long tcp_timeouts;         /**< Expiraciones del temporizador de retransmisión (TcpExt: TCPTimeouts). */
+    unsigned long long tcp_syn_retrans;      /**< SYN retransmitidos (TcpExt: TCPSynRetrans). */
+    unsigned long long udp_in_datagrams;     /**< Datagramas UDP recibidos (Udp: InDatagrams). */
+    unsigned long long udp_out_datagrams;    /**< Datagramas UDP enviados (Udp: OutDatagrams). */
+    unsigned long long udp_no_ports;         /**< Datagramas UDP sin socket destino (Udp: NoPorts). */
+    unsigned long long udp_in_errors;        /**< Datagramas UDP recibidos con error (Udp: InErrors). */
+    unsigned long long udp_rcvbuf_errors;    /**< Descartes por buffer de recepción lleno (Udp: RcvbufErrors). */
+    unsigned long long udp_sndbuf_errors;    /**< Descartes por buffer de envío lleno (Udp: SndbufErrors). */
+};
+
+/**
+ * @brief Obtiene los contadores de protocolo TCP/UDP desde /proc/net/snmp y /proc/net/netstat.
+ *
+ * Ambos archivos se componen de pares de líneas "Proto: Campo1 Campo2 ..." seguidas de
+ * "Proto: valor1 valor2 ...". Se recorren los nombres y valores en paralelo y sólo se guardan
+ * los campos presentes en struct net_proto_stats; los campos que el kernel no exponga quedan en 0.
+ *
+ * @param stats Puntero a la estructura donde se almacenan los contadores.
+ * @return 0 en caso de éxito, o -1 si no se pudo leer /proc/net/snmp.
+ */
+int get_net_proto_stats(struct net_proto_stats* stats);
+
+#endif // METRICS_H
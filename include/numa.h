@@ -0,0 +1,116 @@
+/**
+ * @file numa.h
+ * @brief Topología de CPUs y nodos NUMA desde sysfs, memoria por nodo y uso de CPU por núcleo.
+ *
+ * La topología (nodo y socket de cada CPU) se descubre una sola vez y se guarda en caché. En cada
+ * llamada a numa_topology_refresh() sólo se releen las máscaras de CPUs y nodos en línea; si alguna
+ * cambió (hotplug de CPUs o de memoria) se vuelve a descubrir la topología completa.
+ *
+ * Todas las lecturas pasan por proc_read(), de modo que también se graban y reproducen. Por eso
+ * los nodos y CPUs se obtienen de las listas "online" de sysfs y no recorriendo directorios.
+ */
+
+#ifndef NUMA_H
+#define NUMA_H
+
+#include "proc_source.h"
+
+/**
+ * @brief Cantidad máxima de CPUs consideradas; las de índice mayor se ignoran.
+ */
+#define NUMA_MAX_CPUS 1024
+
+/**
+ * @brief Cantidad máxima de nodos NUMA considerados; los de índice mayor se ignoran.
+ */
+#define NUMA_MAX_NODES 64
+
+/**
+ * @brief Memoria y contadores de asignación de un nodo NUMA.
+ *
+ * La memoria se lee de /sys/devices/system/node/nodeN/meminfo y los contadores de
+ * /sys/devices/system/node/nodeN/numastat (en páginas, acumulados desde el arranque).
+ */
+struct numa_node_stats
+{
+    int node;                          /**< Número de nodo. */
+    unsigned long long mem_total;      /**< Memoria total del nodo en bytes (MemTotal). */
+    unsigned long long mem_free;       /**< Memoria libre del nodo en bytes (MemFree). */
+    unsigned long long mem_used;       /**< Memoria usada del nodo en bytes (MemUsed). */
+    unsigned long long file_pages;     /**< Page cache del nodo en bytes (FilePages). */
+    unsigned long long anon_pages;     /**< Memoria anónima del nodo en bytes (AnonPages). */
+    unsigned long long numa_hit;       /**< Asignaciones hechas en el nodo preferido (numa_hit). */
+    unsigned long long numa_miss;      /**< Asignaciones hechas aquí pero destinadas a otro nodo (numa_miss). */
+    unsigned long long numa_foreign;   /**< Asignaciones destinadas aquí pero hechas en otro nodo (numa_foreign). */
+    unsigned long long interleave_hit; /**< Asignaciones intercaladas hechas en este nodo (interleave_hit). */
+    unsigned long long local_node;     /**< Asignaciones de procesos que corrían en este nodo (local_node). */
+    unsigned long long other_node;     /**< Asignaciones de procesos que corrían en otro nodo (other_node). */
+};
+
+/**
+ * @brief Uso de una CPU en el último intervalo, con su ubicación en la topología.
+ */
+struct cpu_core_usage
+{
+    int cpu;      /**< Número de CPU. */
+    int node;     /**< Nodo NUMA de la CPU (0 si el kernel no expone nodos). */
+    int socket;   /**< Socket físico de la CPU (physical_package_id). */
+    double usage; /**< Uso de la CPU como porcentaje (0.0 a 100.0). */
+};
+
+/**
+ * @brief Comprueba si cambiaron las CPUs o nodos en línea y, si es así, vuelve a descubrir la topología.
+ *
+ * La primera llamada descubre la topología completa. Las máscaras se leen a lo sumo una vez por
+ * ciclo de proc_source: las llamadas siguientes del mismo ciclo devuelven 0.
+ *
+ * @return 1 si la topología se descubrió o cambió, 0 si sigue igual, o -1 en caso de error.
+ */
+int numa_topology_refresh(void);
+
+/**
+ * @brief Devuelve cuántas veces cambió la topología desde que se descubrió por primera vez.
+ */
+unsigned long long numa_topology_changes(void);
+
+/**
+ * @brief Devuelve el nodo NUMA de una CPU según la topología en caché.
+ *
+ * @param cpu Número de CPU.
+ * @return Nodo de la CPU, o -1 si la CPU no está en línea.
+ */
+int numa_cpu_node(int cpu);
+
+/**
+ * @brief Devuelve el socket físico de una CPU según la topología en caché.
+ *
+ * @param cpu Número de CPU.
+ * @return Socket de la CPU, o -1 si la CPU no está en línea.
+ */
+int numa_cpu_socket(int cpu);
+
+/**
+ * @brief Obtiene la memoria y los contadores numastat de cada nodo en línea.
+ *
+ * @param nodes Arreglo donde se guardan las estadísticas.
+ * @param max_nodes Capacidad del arreglo; los nodos sobrantes se ignoran.
+ * @return Cantidad de nodos leídos (0 si el kernel no expone nodos), o -1 en caso de error.
+ */
+int get_numa_node_stats(struct numa_node_stats* nodes, int max_nodes);
+
+/**
+ * @brief Obtiene el uso de cada CPU desde las líneas "cpuN" de /proc/stat.
+ *
+ * Recorre el contenido ya leído por get_cpu_usage(), que no se vuelve a leer. Como
+ * get_cpu_usage(), calcula el uso respecto de la llamada anterior; en la primera llamada, y para
+ * las CPUs que acaban de ponerse en línea, no hay intervalo previo y esas CPUs se omiten.
+ *
+ * @param stat Contenido de /proc/stat leído con proc_read().
+ * @param offset Posición desde la que se recorren las líneas (ver proc_buffer_next_line()).
+ * @param cores Arreglo donde se guarda el uso de cada CPU.
+ * @param max_cores Capacidad del arreglo; las CPUs sobrantes se ignoran.
+ * @return Cantidad de CPUs guardadas, o -1 en caso de error.
+ */
+int get_cpu_core_usage(struct proc_buffer* stat, size_t* offset, struct cpu_core_usage* cores, int max_cores);
+
+#endif // NUMA_H
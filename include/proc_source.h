@@ -0,0 +1,147 @@
+/**
+ * @file proc_source.h
+ * @brief Origen de los datos de /proc: lectura en vivo, grabación a un archivo de captura o reproducción.
+ *
+ * Los colectores leen sus archivos completos con proc_read() en lugar de fopen(). En modo
+ * grabación los bytes leídos se guardan, junto con la marca de tiempo de cada ciclo, en un archivo
+ * de captura comprimido con zlib; en modo reproducción esos mismos bytes se entregan a los parsers
+ * en lugar de los archivos reales.
+ *
+ * proc_read() lee en un buffer creciente que el colector conserva entre ciclos: una vez que el
+ * buffer alcanzó el tamaño del archivo, leerlo no reserva memoria y las líneas nunca se truncan.
+ *
+ * Formato de la captura (texto, opcionalmente comprimido con gzip):
+ * @code
+ * # monitor-capture 1
+ * T <marca de tiempo en ns>
+ * F <ruta> <longitud>
+ * <longitud bytes>
+ * @endcode
+ * Cada línea "T" abre un ciclo de recolección y cada "F" es un archivo leído en ese ciclo. Como
+ * zlib lee archivos sin comprimir de forma transparente, las capturas pueden escribirse a mano.
+ */
+
+#ifndef PROC_SOURCE_H
+#define PROC_SOURCE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/**
+ * @brief Buffer de lectura creciente que se conserva entre ciclos.
+ */
+struct proc_buffer
+{
+    char* data;      /**< Contenido del archivo, terminado en '\0'. */
+    size_t len;      /**< Bytes válidos en data. */
+    size_t capacity; /**< Bytes reservados en data. */
+};
+
+/**
+ * @brief Modos de operación del origen de datos.
+ */
+enum proc_source_mode
+{
+    PROC_SOURCE_LIVE,   /**< Lee los archivos reales (por defecto). */
+    PROC_SOURCE_RECORD, /**< Lee los archivos reales y los graba en la captura. */
+    PROC_SOURCE_REPLAY  /**< Lee los archivos desde la captura. */
+};
+
+/**
+ * @brief Comienza a grabar en un archivo de captura.
+ *
+ * @param capture_path Ruta del archivo de captura a crear.
+ * @return 0 en caso de éxito, o -1 en caso de error.
+ */
+int proc_source_record(const char* capture_path);
+
+/**
+ * @brief Comienza a reproducir un archivo de captura.
+ *
+ * @param capture_path Ruta del archivo de captura.
+ * @param realtime Si es true, respeta los intervalos grabados; si no, reproduce lo más rápido posible.
+ * @param loop Si es true, vuelve al principio al terminar la captura.
+ * @return 0 en caso de éxito, o -1 en caso de error.
+ */
+int proc_source_replay(const char* capture_path, bool realtime, bool loop);
+
+/**
+ * @brief Devuelve el modo de operación actual.
+ */
+enum proc_source_mode proc_source_mode(void);
+
+/**
+ * @brief Marca el comienzo de un ciclo de recolección.
+ *
+ * En grabación escribe el ciclo anterior en la captura; en reproducción carga el siguiente ciclo.
+ *
+ * @return 0 en caso de éxito, o -1 si la reproducción terminó o hubo un error.
+ */
+int proc_source_begin_tick(void);
+
+/**
+ * @brief Devuelve el momento del ciclo actual en segundos desde la época.
+ *
+ * En vivo y en grabación es el momento en que comenzó el ciclo; en reproducción, el grabado en la
+ * captura, de modo que los cálculos que dependen del tiempo (p. ej. tasas) dan lo mismo que al grabar.
+ */
+double proc_source_tick_time(void);
+
+/**
+ * @brief Devuelve cuánto debe esperarse hasta el próximo ciclo de recolección.
+ *
+ * El bucle principal la suma al plazo absoluto del ciclo actual para obtener el del siguiente.
+ *
+ * @param interval Intervalo configurado en segundos.
+ * @return Espera en segundos: el intervalo configurado en vivo y en grabación, la diferencia entre
+ *         las marcas de tiempo grabadas en reproducción, o 0 si se reproduce lo más rápido posible.
+ */
+double proc_source_period(int interval);
+
+/**
+ * @brief Lee un archivo de /proc o sysfs completo según el modo actual.
+ *
+ * Dentro de un mismo ciclo, leer varias veces la misma ruta entrega los mismos bytes (en grabación
+ * y reproducción), de modo que todos los colectores ven una instantánea consistente.
+ *
+ * @param path Ruta del archivo.
+ * @param buffer Buffer donde se guarda el contenido; sólo crece si el archivo no entra.
+ * @return 0 en caso de éxito, o -1 en caso de error (errno indica la causa).
+ */
+int proc_read(const char* path, struct proc_buffer* buffer);
+
+/**
+ * @brief Devuelve la siguiente línea del contenido leído con proc_read().
+ *
+ * Reemplaza el salto de línea por '\0', así que modifica el buffer.
+ *
+ * @param buffer Buffer leído con proc_read().
+ * @param offset Posición de la próxima línea; debe comenzar en 0.
+ * @return La línea sin el salto de línea, o NULL si no quedan líneas.
+ */
+char* proc_buffer_next_line(struct proc_buffer* buffer, size_t* offset);
+
+/**
+ * @brief Agrega bytes obtenidos por otro medio (p. ej. netlink) al ciclo que se está grabando.
+ *
+ * @param name Nombre de la entrada en la captura.
+ * @param data Bytes a agregar.
+ * @param len Cantidad de bytes.
+ */
+void proc_source_append(const char* name, const void* data, size_t len);
+
+/**
+ * @brief Busca una entrada del ciclo que se está reproduciendo.
+ *
+ * @param name Nombre de la entrada.
+ * @param len Puntero donde se guarda la longitud de la entrada.
+ * @return Puntero a los bytes de la entrada, o NULL si el ciclo no la contiene.
+ */
+const char* proc_source_lookup(const char* name, size_t* len);
+
+/**
+ * @brief Termina la grabación o reproducción y cierra la captura.
+ */
+void proc_source_close(void);
+
+#endif // PROC_SOURCE_H
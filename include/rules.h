@@ -0,0 +1,129 @@
+/**
+ * @file rules.h
+ * @brief Reglas de alerta evaluadas en el agente sobre cada muestra nueva.
+ *
+ * Cada regla observa una serie (familia y valores de todas sus etiquetas) y compara con un umbral
+ * su valor o, con "rate", su aumento por segundo en una ventana. La regla pasa a "pending" cuando
+ * la comparación se cumple y a "firing" cuando se cumplió durante "for" segundos; vuelve a
+ * "inactive" en cuanto deja de cumplirse, cuando su serie se marca como obsoleta o cuando pasan
+ * RULE_STALE_PERIODS períodos sin muestras de ella.
+ *
+ * La evaluación es incremental: series_set() entrega cada muestra de las familias observadas y la
+ * regla actualiza su estado en O(1) amortizado. La tasa usa un buffer circular con las muestras de
+ * la ventana, espaciadas para que la ventana entera entre en él, del que se descartan las que
+ * quedaron fuera; nunca se recorre un historial.
+ *
+ * Al disparar y al resolverse, la regla encola un evento que atiende un hilo propio: un POST JSON a
+ * un webhook http:// y/o la ejecución de un programa con el nombre de la regla, el estado y el
+ * valor como argumentos. Si la cola está llena el evento se descarta y se cuenta: la recolección
+ * nunca espera a una acción.
+ */
+
+#ifndef RULES_H
+#define RULES_H
+
+#include "config.h"
+
+/**
+ * @brief Cantidad máxima de muestras en la ventana de una tasa; si el intervalo es menor que
+ * rate / (RULE_MAX_SAMPLES - 3), se guarda una muestra por cada tramo de ese largo.
+ */
+#define RULE_MAX_SAMPLES 64
+
+/**
+ * @brief Períodos de recolección sin muestras de su serie tras los que una regla vuelve a "inactive".
+ */
+#define RULE_STALE_PERIODS 3
+
+/**
+ * @brief Cantidad máxima de eventos esperando a su acción.
+ */
+#define RULE_EVENT_QUEUE_SIZE 64
+
+/**
+ * @brief Segundos máximos de espera al conectar con un webhook, enviarle el evento y leer su respuesta,
+ * y a que termine el programa de exec (pasado ese tiempo se lo mata).
+ */
+#define RULE_WEBHOOK_TIMEOUT 2
+
+/**
+ * @brief Estado de una regla, en el orden en que se expone en rule_state.
+ */
+enum rule_state
+{
+    RULE_INACTIVE, /**< La comparación no se cumple. */
+    RULE_PENDING,  /**< La comparación se cumple desde hace menos de "for" segundos. */
+    RULE_FIRING    /**< La comparación se cumple desde hace al menos "for" segundos. */
+};
+
+/**
+ * @brief Estado de una regla para exponerlo como métricas.
+ */
+struct rule_status
+{
+    const char* name;         /**< Nombre de la regla. */
+    enum rule_state state;    /**< Estado actual. */
+    double value;             /**< Último valor comparado (valor o tasa; NaN si todavía no hay tasa). */
+    unsigned long long fired; /**< Veces que pasó a "firing". */
+};
+
+/**
+ * @brief Resultado de las acciones desde el arranque.
+ */
+struct rule_action_stats
+{
+    unsigned long long ok;      /**< Acciones terminadas con éxito (respuesta 2xx o código de salida 0). */
+    unsigned long long failed;  /**< Acciones que fallaron. */
+    unsigned long long dropped; /**< Eventos descartados porque la cola estaba llena. */
+};
+
+/**
+ * @brief Inicia el hilo que ejecuta las acciones.
+ *
+ * Los programas de las acciones empiezan sin señales bloqueadas, aunque el agente bloquee algunas.
+ *
+ * @return 0 en caso de éxito, o -1 en caso de error.
+ */
+int rules_init(void);
+
+/**
+ * @brief Aplica las reglas de una configuración si es distinta de la anterior.
+ *
+ * Las reglas que siguen existiendo con el mismo nombre y la misma serie conservan su estado; las
+ * que se quitan estando en "firing" envían el evento de resolución. Debe llamarla el hilo de
+ * recolección, después de init_metrics() y antes de actualizar las series del ciclo.
+ *
+ * @param config Configuración del ciclo, tomada con config_acquire().
+ */
+void rules_configure(const struct config* config);
+
+/**
+ * @brief Da por inactivas las reglas cuya serie dejó de recibir muestras.
+ *
+ * Una regla sin muestras durante RULE_STALE_PERIODS períodos (el intervalo máximo si la
+ * configuración es "adaptive") vuelve a "inactive", enviando el evento de resolución si estaba en
+ * "firing", y su ventana vuelve a empezar. Debe llamarla el hilo de recolección en cada ciclo,
+ * después de actualizar las series.
+ *
+ * @param config Configuración del ciclo, tomada con config_acquire().
+ * @return Cantidad de reglas que cambiaron de estado o de valor.
+ */
+size_t rules_expire(const struct config* config);
+
+/**
+ * @brief Obtiene el estado de las reglas activas.
+ *
+ * @param status Arreglo donde se guarda el estado; los nombres son válidos hasta la próxima configuración.
+ * @param max_rules Capacidad del arreglo.
+ * @return Cantidad de reglas guardadas.
+ */
+size_t rules_get_status(struct rule_status* status, size_t max_rules);
+
+/**
+ * @brief Obtiene el resultado de las acciones desde el arranque.
+ *
+ * @param stats Puntero donde se guardan los contadores.
+ */
+void rules_get_action_stats(struct rule_action_stats* stats);
+
+#endif // RULES_H
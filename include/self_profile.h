@@ -0,0 +1,98 @@
+/**
+ * @file self_profile.h
+ * @brief Perfilado del propio agente con contadores de software de perf_event.
+ *
+ * Atribuye a cada sección (cada colector, la actualización de las reglas y del ciclo, y los scrapes
+ * de cada formato) el tiempo de CPU (task-clock), los fallos de página y los cambios de contexto
+ * del hilo que la ejecuta. Cada hilo abre una sola vez un grupo con los eventos de software
+ * task-clock y page-faults con perf_event_open(), limitado a sí mismo y con exclude_kernel (lo que
+ * permite perf_event_paranoid 2 sin privilegios), y lee ambos con un único read() al empezar y al
+ * terminar cada sección. Los cambios de contexto ocurren dentro del kernel, así que se toman de
+ * getrusage(RUSAGE_THREAD). No depende del hardware (no usa contadores de la PMU), así que funciona
+ * en máquinas virtuales y contenedores.
+ *
+ * Si el kernel no permite perf_event_open() (perf_event_paranoid 3 o más, seccomp), el hilo usa
+ * CLOCK_THREAD_CPUTIME_ID y getrusage(RUSAGE_THREAD), que dan las mismas magnitudes con menos
+ * resolución. /debug/profile indica qué fuente se usa y, si no es perf_event, por qué. Si una
+ * lectura falla, la muestra se descarta en lugar de mezclar fuentes.
+ *
+ * Se activa con "profile" en la configuración; desactivado, cada sección cuesta una lectura
+ * atómica. El resultado se consulta en /debug/profile.
+ */
+
+#ifndef SELF_PROFILE_H
+#define SELF_PROFILE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/**
+ * @brief Cantidad máxima de secciones perfiladas.
+ */
+#define SELF_PROFILE_MAX_SECTIONS 32
+
+/**
+ * @brief Contadores leídos en cada sección.
+ */
+enum self_profile_counter
+{
+    SELF_PROFILE_TASK_CLOCK,       /**< Tiempo de CPU del hilo, en nanosegundos. */
+    SELF_PROFILE_PAGE_FAULTS,      /**< Fallos de página. */
+    SELF_PROFILE_CONTEXT_SWITCHES, /**< Cambios de contexto, voluntarios e involuntarios. */
+    SELF_PROFILE_COUNTER_COUNT
+};
+
+/**
+ * @brief Lectura de los contadores del hilo al empezar una sección.
+ */
+struct self_profile_sample
+{
+    bool valid;                                                /**< false si el perfilado estaba desactivado. */
+    unsigned long long values[SELF_PROFILE_COUNTER_COUNT];     /**< Valores acumulados del hilo. */
+};
+
+/**
+ * @brief Registra una sección, o devuelve la ya registrada con ese nombre.
+ *
+ * Debe llamarse desde un solo hilo; las secciones se registran al iniciar.
+ *
+ * @param name Nombre de la sección; debe seguir siendo válido mientras dure el programa.
+ * @return Identificador de la sección, o -1 si no quedan lugares.
+ */
+int self_profile_section(const char* name);
+
+/**
+ * @brief Activa o desactiva el perfilado; lo llama el planificador en cada ciclo.
+ */
+void self_profile_set_enabled(bool enabled);
+
+/**
+ * @brief Indica si el perfilado está activado.
+ */
+bool self_profile_enabled(void);
+
+/**
+ * @brief Lee los contadores del hilo actual al empezar una sección.
+ *
+ * La primera llamada de cada hilo abre sus eventos.
+ */
+void self_profile_begin(struct self_profile_sample* start);
+
+/**
+ * @brief Suma a la sección lo que consumió el hilo desde self_profile_begin().
+ *
+ * @param section Identificador devuelto por self_profile_section(); se ignora si es negativo.
+ * @param start Lectura tomada al empezar la sección.
+ */
+void self_profile_end(int section, const struct self_profile_sample* start);
+
+/**
+ * @brief Escribe una tabla con el costo acumulado de cada sección.
+ *
+ * @param buffer Destino del texto.
+ * @param size Tamaño del destino.
+ * @return Bytes escritos (la tabla se trunca si no entra).
+ */
+size_t self_profile_render(char* buffer, size_t size);
+
+#endif // SELF_PROFILE_H
@@ -0,0 +1,287 @@
+/**
+ * @file series.h
+ * @brief Tabla de series con cantidad máxima fija, etiquetas internadas y desalojo LRU.
+ *
+ * Reemplaza al registro de prometheus-client-c, que no permite dar de baja series: con etiquetas
+ * por interfaz o por dispositivo, las veths y discos efímeros lo harían crecer sin límite.
+ *
+ * Toda la memoria se reserva en series_table_init(): al alcanzar la capacidad se desaloja la
+ * serie actualizada hace más tiempo. Las series sin etiquetas no se desalojan nunca. Los
+ * colectores que enumeran series (p. ej. una por interfaz) encierran sus actualizaciones entre
+ * series_sweep_begin() y series_sweep_end(); las series que no se actualizaron en la pasada se
+ * marcan como obsoletas y dejan de exponerse, con lo que Prometheus las da por terminadas.
+ *
+ * La tabla se expone en tres formatos generados directamente desde las series, sin copias
+ * intermedias: el de texto de Prometheus, OpenMetrics (con ejemplares y el momento de creación de
+ * los contadores) y el protobuf delimitado de Prometheus.
+ *
+ * Las funciones no son thread-safe: deben llamarse con el mutex de las métricas tomado.
+ */
+
+#ifndef SERIES_H
+#define SERIES_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/**
+ * @brief Cantidad máxima de etiquetas por familia.
+ */
+#define SERIES_MAX_LABELS 4
+
+/**
+ * @brief Tamaño máximo (incluyendo el terminador) de un valor de etiqueta internado.
+ */
+#define SERIES_LABEL_SIZE 64
+
+/**
+ * @brief Cantidad máxima de familias de métricas.
+ */
+#define SERIES_MAX_FAMILIES 128
+
+/**
+ * @brief Capacidad por defecto de la tabla de series.
+ */
+#define SERIES_DEFAULT_CAPACITY 10000
+
+/**
+ * @brief Tipo de métrica de una familia.
+ */
+enum series_type
+{
+    SERIES_GAUGE,  /**< Valor que puede subir o bajar. */
+    SERIES_COUNTER /**< Valor acumulado que sólo crece. */
+};
+
+/**
+ * @brief Estadísticas de la tabla, expuestas como métricas propias.
+ */
+struct series_stats
+{
+    size_t capacity;              /**< Cantidad máxima de series. */
+    size_t active;                /**< Series expuestas actualmente. */
+    size_t stale;                 /**< Series obsoletas que todavía ocupan lugar. */
+    unsigned long long evictions; /**< Series activas desalojadas por falta de lugar. */
+    unsigned long long staled;    /**< Series marcadas como obsoletas por desaparecer de su colector. */
+    int last_evicted_family;      /**< Familia de la última serie desalojada (-1 si no hubo). */
+};
+
+/**
+ * @brief Buffer de texto creciente que se conserva entre usos.
+ */
+struct series_buffer
+{
+    char* data;      /**< Contenido, terminado en '\0'. */
+    size_t len;      /**< Bytes válidos en data. */
+    size_t capacity; /**< Bytes reservados en data. */
+};
+
+/**
+ * @brief Familias que escribe cada función de exposición.
+ *
+ * Una exposición completa puede generarse de una vez (SERIES_PART_ALL) o en dos partes: las series
+ * observadas, que se generan sólo cuando cambia series_version(), y a continuación las de la
+ * contabilidad del agente, que cambian en cada ciclo (ver series_family_set_self()).
+ */
+enum series_part
+{
+    SERIES_PART_ALL,      /**< Todas las familias; se sobrescribe el buffer. */
+    SERIES_PART_OBSERVED, /**< Todas menos las del agente, sin el "# EOF" de OpenMetrics; se sobrescribe. */
+    SERIES_PART_SELF      /**< Sólo las del agente, agregadas al final de lo que ya tiene el buffer. */
+};
+
+/**
+ * @brief Función que recibe cada muestra de una familia observada.
+ *
+ * Se llama desde series_set(), con el mutex de las métricas tomado, aunque el valor no haya
+ * cambiado, y desde series_sweep_end() con NaN por cada serie que se marca como obsoleta. No debe
+ * modificar la tabla.
+ *
+ * @param family Identificador de la familia.
+ * @param label_values Valores de las etiquetas, en el orden de label_keys (NULL si no tiene).
+ * @param value Valor de la muestra.
+ */
+typedef void (*series_sample_hook)(int family, const char** label_values, double value);
+
+/**
+ * @brief Reserva la tabla de series y el espacio de etiquetas internadas.
+ *
+ * @param capacity Cantidad máxima de series.
+ * @return 0 en caso de éxito, o -1 en caso de error.
+ */
+int series_table_init(size_t capacity);
+
+/**
+ * @brief Registra una familia de métricas.
+ *
+ * @param name Nombre de la métrica.
+ * @param help Descripción de la métrica.
+ * @param type Tipo de la métrica.
+ * @param label_count Cantidad de etiquetas (0 a SERIES_MAX_LABELS).
+ * @param label_keys Nombres de las etiquetas.
+ * @return Identificador de la familia, o -1 en caso de error.
+ */
+int series_family_new(const char* name, const char* help, enum series_type type, size_t label_count,
+                      const char** label_keys);
+
+/**
+ * @brief Fija el momento de creación que se expone para todas las series de una familia.
+ *
+ * Por defecto cada serie se expone como creada cuando se actualizó por primera vez. Los contadores
+ * que el kernel acumula desde el arranque deben usar el momento del arranque: de lo contrario
+ * Prometheus interpretaría todo lo acumulado como un aumento ocurrido al crearse la serie.
+ *
+ * @param family Identificador devuelto por series_family_new().
+ * @param created Momento de creación en segundos desde la época.
+ */
+void series_family_set_created(int family, double created);
+
+/**
+ * @brief Marca una familia como contabilidad del propio agente (duración del ciclo, ejecuciones de
+ * cada colector).
+ *
+ * Sus valores cambian en cada ciclo aunque no cambie nada de lo observado, así que cambiarlos no
+ * modifica series_version() sino series_self_version(): no obligan a regenerar las series
+ * observadas ni cuentan como novedad de un colector. Crear o dejar de exponer una de sus series sí
+ * cambia series_version().
+ *
+ * @param family Identificador devuelto por series_family_new().
+ */
+void series_family_set_self(int family);
+
+/**
+ * @brief Devuelve el nombre de una familia.
+ *
+ * @param family Identificador devuelto por series_family_new().
+ * @return Nombre de la familia, o NULL si no existe.
+ */
+const char* series_family_name(int family);
+
+/**
+ * @brief Busca una familia por nombre.
+ *
+ * @param name Nombre de la métrica.
+ * @return Identificador de la familia, o -1 si no existe.
+ */
+int series_family_find(const char* name);
+
+/**
+ * @brief Obtiene los nombres de las etiquetas de una familia.
+ *
+ * @param family Identificador de la familia.
+ * @param keys Arreglo de SERIES_MAX_LABELS punteros donde se guardan los nombres.
+ * @return Cantidad de etiquetas, o 0 si la familia no existe.
+ */
+size_t series_family_label_keys(int family, const char** keys);
+
+/**
+ * @brief Observa las muestras de una familia; cada familia admite una sola función.
+ *
+ * @param family Identificador de la familia.
+ * @param hook Función a llamar con cada muestra, o NULL para dejar de observarla.
+ */
+void series_family_set_hook(int family, series_sample_hook hook);
+
+/**
+ * @brief Actualiza (o crea) una serie de una familia.
+ *
+ * @param family Identificador devuelto por series_family_new().
+ * @param label_values Valores de las etiquetas, en el orden de label_keys (NULL si no tiene).
+ * @param value Nuevo valor.
+ * @return 0 en caso de éxito, o -1 en caso de error.
+ */
+int series_set(int family, const char** label_values, double value);
+
+/**
+ * @brief Asocia un ejemplar a una serie existente; cada familia conserva sólo el último.
+ *
+ * El ejemplar se expone en OpenMetrics y en protobuf junto con el momento en que se registró.
+ *
+ * @param family Identificador de la familia.
+ * @param label_values Valores de las etiquetas de la serie (NULL si no tiene).
+ * @param key Nombre de la etiqueta del ejemplar.
+ * @param value Valor de la etiqueta del ejemplar; se trunca a SERIES_LABEL_SIZE - 1 bytes.
+ * @param sample Valor observado del ejemplar.
+ * @return 0 en caso de éxito, o -1 si la serie no existe.
+ */
+int series_set_exemplar(int family, const char** label_values, const char* key, const char* value, double sample);
+
+/**
+ * @brief Comienza una pasada completa de un colector sobre las series de una familia.
+ *
+ * @param family Identificador de la familia.
+ */
+void series_sweep_begin(int family);
+
+/**
+ * @brief Termina la pasada y marca como obsoletas las series que no se actualizaron.
+ *
+ * Si la familia tiene una función que observa sus muestras, la llama con NaN por cada una.
+ *
+ * @param family Identificador de la familia.
+ */
+void series_sweep_end(int family);
+
+/**
+ * @brief Obtiene las estadísticas de la tabla.
+ *
+ * @param stats Puntero donde se guardan las estadísticas.
+ */
+void series_get_stats(struct series_stats* stats);
+
+/**
+ * @brief Devuelve la versión de la tabla, que cambia sólo cuando cambia algo que se expone.
+ *
+ * Actualizar una serie con el mismo valor, o una de una familia marcada con
+ * series_family_set_self(), no la cambia; crear, desalojar u ocultar una serie, o cambiar un
+ * ejemplar, sí. Permite reutilizar las series observadas ya generadas mientras la versión no
+ * cambie y saber si un colector publicó algo nuevo.
+ */
+unsigned long long series_version(void);
+
+/**
+ * @brief Devuelve la versión de los valores de las familias marcadas con series_family_set_self().
+ */
+unsigned long long series_self_version(void);
+
+/**
+ * @brief Copia el contenido de un buffer en otro, que crece si hace falta.
+ *
+ * @return 0 en caso de éxito, o -1 si no se pudo reservar memoria.
+ */
+int series_buffer_copy(struct series_buffer* buffer, const struct series_buffer* source);
+
+/**
+ * @brief Escribe las series activas en el formato de texto de Prometheus.
+ *
+ * @param buffer Buffer de salida; crece si hace falta.
+ * @param part Familias a escribir.
+ * @return 0 en caso de éxito, o -1 si no se pudo reservar memoria.
+ */
+int series_render_text(struct series_buffer* buffer, enum series_part part);
+
+/**
+ * @brief Escribe las series activas en el formato de texto OpenMetrics 1.0.0.
+ *
+ * Los contadores se exponen con el sufijo _total, una muestra _created y el ejemplar de la familia
+ * si lo tiene. La exposición termina con "# EOF", salvo con SERIES_PART_OBSERVED.
+ *
+ * @param buffer Buffer de salida; crece si hace falta.
+ * @param part Familias a escribir.
+ * @return 0 en caso de éxito, o -1 si no se pudo reservar memoria.
+ */
+int series_render_openmetrics(struct series_buffer* buffer, enum series_part part);
+
+/**
+ * @brief Escribe las series activas como mensajes io.prometheus.client.MetricFamily delimitados.
+ *
+ * Cada familia se codifica precedida de su longitud en varint, como espera Prometheus con
+ * "encoding=delimited". Los contadores incluyen created_timestamp y el ejemplar de la familia.
+ *
+ * @param buffer Buffer de salida; crece si hace falta. Contiene datos binarios.
+ * @param part Familias a escribir.
+ * @return 0 en caso de éxito, o -1 si no se pudo reservar memoria.
+ */
+int series_render_protobuf(struct series_buffer* buffer, enum series_part part);
+
+#endif // SERIES_H
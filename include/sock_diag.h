@@ -0,0 +1,86 @@
+/**
+ * @file sock_diag.h
+ * @brief Histograma de sockets TCP/UDP por estado y tamaño de cola obtenido vía netlink INET_DIAG.
+ */
+
+#ifndef SOCK_DIAG_H
+#define SOCK_DIAG_H
+
+#include <netinet/in.h>
+
+/**
+ * @brief Cantidad de estados TCP del kernel (TCP_ESTABLISHED = 1 ... TCP_NEW_SYN_RECV = 12).
+ */
+#define SOCK_STATE_COUNT 13
+
+/**
+ * @brief Estados del kernel con un significado propio en el histograma.
+ *
+ * Los sockets UDP sólo se reportan como TCP_ESTABLISHED (conectados) o TCP_CLOSE (sin conectar).
+ */
+#define SOCK_STATE_ESTABLISHED 1
+#define SOCK_STATE_CLOSE 7
+#define SOCK_STATE_LISTEN 10
+
+/**
+ * @brief Cantidad de buckets del histograma de colas.
+ *
+ * El bucket 0 cuenta colas vacías, el bucket i (1 <= i < SOCK_QUEUE_BUCKETS - 1) cuenta colas
+ * de entre 2^(i-1) y 2^i - 1 bytes, y el último bucket cuenta el resto.
+ */
+#define SOCK_QUEUE_BUCKETS 24
+
+/**
+ * @brief Histograma de sockets de un protocolo agregado durante un volcado INET_DIAG.
+ *
+ * En un socket en LISTEN, Recv-Q es la cantidad de conexiones esperando accept() y Send-Q el
+ * backlog máximo, no bytes: esos sockets no entran en recv_queue ni en send_queue sino en
+ * accept_queue.
+ */
+struct sock_histogram
+{
+    unsigned long long total;                              /**< Sockets recorridos. */
+    unsigned long long by_state[SOCK_STATE_COUNT];         /**< Sockets por estado TCP del kernel. */
+    unsigned long long recv_queue[SOCK_QUEUE_BUCKETS];     /**< Sockets por bucket de Recv-Q en bytes (no acumulado). */
+    unsigned long long send_queue[SOCK_QUEUE_BUCKETS];     /**< Sockets por bucket de Send-Q en bytes (no acumulado). */
+    unsigned long long accept_queue[SOCK_QUEUE_BUCKETS];   /**< Sockets en LISTEN por bucket de conexiones sin aceptar. */
+};
+
+/**
+ * @brief Obtiene el histograma de sockets de un protocolo mediante un volcado INET_DIAG.
+ *
+ * Envía una petición NLM_F_DUMP por cada familia (AF_INET y AF_INET6) y agrega cada
+ * inet_diag_msg directamente en el histograma, sin construir cadenas por socket como
+ * requeriría parsear /proc/net/tcp. Respeta el modo de grabación/reproducción de proc_source.h.
+ *
+ * @param protocol IPPROTO_TCP o IPPROTO_UDP.
+ * @param hist Puntero al histograma a completar; se pone a cero antes de agregar.
+ * @return 0 en caso de éxito, o -1 en caso de error.
+ */
+int get_socket_histogram(int protocol, struct sock_histogram* hist);
+
+/**
+ * @brief Devuelve el nombre en minúsculas de un estado TCP del kernel.
+ *
+ * @param state Estado TCP (índice de by_state).
+ * @return Nombre del estado, o "unknown" si está fuera de rango.
+ */
+const char* sock_state_name(int state);
+
+/**
+ * @brief Devuelve el nombre del estado de un socket UDP.
+ *
+ * @param state Estado del kernel (índice de by_state).
+ * @return "connected", "unconnected", o NULL si UDP no usa ese estado.
+ */
+const char* sock_udp_state_name(int state);
+
+/**
+ * @brief Devuelve el límite superior (inclusive) de un bucket del histograma de colas.
+ *
+ * @param bucket Índice del bucket.
+ * @return Límite superior (bytes, o conexiones en accept_queue), o -1 para el último bucket (+Inf).
+ */
+long long sock_queue_bucket_bound(int bucket);
+
+#endif // SOCK_DIAG_H
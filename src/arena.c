@@ -0,0 +1,54 @@
+#include "../include/arena.h"
+#include <stdalign.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+/** Alineación de cada reserva, la misma que garantiza malloc() */
+#define ARENA_ALIGNMENT alignof(max_align_t)
+
+int arena_init(struct arena* arena, size_t capacity)
+{
+    arena->base = malloc(capacity);
+    if (arena->base == NULL)
+    {
+        perror("Error al reservar memoria para la arena");
+        return -1;
+    }
+
+    arena->capacity = capacity;
+    arena->used = 0;
+    arena->peak = 0;
+    arena->exhausted = false;
+    return 0;
+}
+
+void* arena_alloc(struct arena* arena, size_t size)
+{
+    size_t start = (arena->used + ARENA_ALIGNMENT - 1) & ~(ARENA_ALIGNMENT - 1);
+    if (start > arena->capacity || size > arena->capacity - start)
+    {
+        arena->exhausted = true;
+        return NULL;
+    }
+
+    arena->used = start + size;
+    if (arena->used > arena->peak)
+    {
+        arena->peak = arena->used;
+    }
+    return arena->base + start;
+}
+
+void arena_reset(struct arena* arena)
+{
+    arena->used = 0;
+    arena->exhausted = false;
+}
+
+void arena_destroy(struct arena* arena)
+{
+    free(arena->base);
+    arena->base = NULL;
+    arena->capacity = 0;
+    arena->used = 0;
+}
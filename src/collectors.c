@@ -0,0 +1,113 @@
+#include "../include/collectors.h"
+#include "../include/expose_metrics.h"
+#include "../include/self_profile.h"
+#include <stddef.h>
+
+/**
+ * @brief Colector: función que actualiza un grupo de métricas y su frecuencia actual.
+ */
+struct collector
+{
+    const char* name;             /**< Nombre del colector, igual que su clave en "metrics". */
+    size_t enabled;               /**< Desplazamiento del bool que lo activa en struct config. */
+    void (*update)(void);         /**< Función que lee la fuente y actualiza las series. */
+    unsigned int period;          /**< Ciclos entre ejecuciones. */
+    unsigned int countdown;       /**< Ciclos que faltan para la próxima ejecución. */
+    unsigned long long runs;      /**< Ejecuciones desde el arranque. */
+    int profile_section;          /**< Sección de /debug/profile con su costo. */
+};
+
+/** Configuración con la que se calcularon los períodos; al cambiar se vuelve a empezar */
+static const struct config* current_config = NULL;
+
+/**
+ * @brief Actualiza el uso de CPU; el uso por núcleo y la topología sólo con las métricas NUMA.
+ */
+static void update_cpu_gauges(void)
+{
+    update_cpu_gauge(current_config->show_numa_stats);
+}
+
+/**
+ * @brief Actualiza las dos métricas de memoria juntas: comparten la fuente.
+ */
+static void update_memory_gauges(void)
+{
+    update_memory_gauge();
+    update_memory_gauge2();
+}
+
+static struct collector collectors[] = {
+    {"cpu", offsetof(struct config, show_cpu_usage), update_cpu_gauges, 1, 0, 0, -1},
+    {"memory", offsetof(struct config, show_memory_usage), update_memory_gauges, 1, 0, 0, -1},
+    {"disk_io", offsetof(struct config, show_disk_io), update_disk_io_gauge, 1, 0, 0, -1},
+    {"network_stats", offsetof(struct config, show_network_stats), update_network_gauge, 1, 0, 0, -1},
+    {"process_count", offsetof(struct config, show_process_count), update_process_count_gauge, 1, 0, 0, -1},
+    {"context_switches", offsetof(struct config, show_context_switches), update_context_switches_gauge, 1, 0, 0, -1},
+    {"socket_stats", offsetof(struct config, show_socket_stats), update_socket_stats_gauge, 1, 0, 0, -1},
+    {"numa", offsetof(struct config, show_numa_stats), update_numa_gauge, 1, 0, 0, -1},
+};
+
+#define COLLECTOR_COUNT (sizeof(collectors) / sizeof(collectors[0]))
+
+int collectors_run(const struct config* config)
+{
+    // Una configuración nueva se aplica de inmediato: todos los colectores se ejecutan en este ciclo
+    if (config != current_config)
+    {
+        for (size_t i = 0; i < COLLECTOR_COUNT; i++)
+        {
+            // La primera vez se registran también sus secciones de /debug/profile
+            if (current_config == NULL)
+            {
+                collectors[i].profile_section = self_profile_section(collectors[i].name);
+            }
+            collectors[i].period = 1;
+            collectors[i].countdown = 0;
+        }
+        current_config = config;
+    }
+
+    unsigned int max_period = 1;
+    if (config->adaptive && config->max_interval > config->interval)
+    {
+        max_period = (unsigned int)(config->max_interval / config->interval);
+    }
+
+    int ran = 0;
+    for (size_t i = 0; i < COLLECTOR_COUNT; i++)
+    {
+        struct collector* collector = &collectors[i];
+        if (!*(const bool*)((const char*)config + collector->enabled))
+        {
+            continue;
+        }
+        if (collector->countdown > 0)
+        {
+            collector->countdown--;
+            continue;
+        }
+
+        // Sólo este hilo modifica la tabla, así que puede leer la versión sin tomar el mutex
+        unsigned long long version = series_version();
+        struct self_profile_sample profile_start;
+        self_profile_begin(&profile_start);
+        collector->update();
+        self_profile_end(collector->profile_section, &profile_start);
+        collector->runs++;
+        ran++;
+
+        if (series_version() != version)
+        {
+            collector->period = 1;
+        }
+        else if (collector->period < max_period)
+        {
+            collector->period = collector->period * 2 < max_period ? collector->period * 2 : max_period;
+        }
+        collector->countdown = collector->period - 1;
+
+        update_collector_gauge(collector->name, (double)collector->period * config->interval, collector->runs);
+    }
+    return ran;
+}
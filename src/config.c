@@ -0,0 +1,554 @@
+#include "../include/config.h"
+#include "../include/arena.h"
+#include "../include/series.h"
+#include <cjson/cJSON.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <poll.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <sys/signalfd.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define DEFAULT_INTERVAL 5
+#define DEFAULT_MAX_INTERVAL 60
+#define INOTIFY_BUFFER_SIZE 4096
+
+/** Lugares para las configuraciones; sólo el hilo que recarga escribe en ellos */
+static struct config slots[CONFIG_SLOTS];
+
+/** Configuración publicada y la que está usando el planificador (hazard pointer) */
+static _Atomic(struct config*) published = NULL;
+static _Atomic(struct config*) in_use = NULL;
+
+/** Arena del archivo y del árbol cJSON; la usa un solo hilo a la vez (el arranque o el de recarga) */
+static struct arena config_arena;
+
+static char config_path[PATH_MAX];
+static char config_dir[PATH_MAX];
+static const char* config_name = NULL;
+
+static int wake_fd = -1;
+
+/**
+ * @brief Reserva memoria para cJSON dentro de la arena de configuración.
+ */
+static void* config_malloc(size_t size)
+{
+    return arena_alloc(&config_arena, size);
+}
+
+/**
+ * @brief No libera nada: la memoria de cJSON se libera toda junta con arena_reset().
+ */
+static void config_free(void* ptr)
+{
+    (void)ptr;
+}
+
+/**
+ * @brief Completa una configuración con todas las métricas activas y el intervalo por defecto.
+ */
+static void default_config(struct config* config)
+{
+    config->show_cpu_usage = true;
+    config->show_memory_usage = true;
+    config->show_disk_io = true;
+    config->show_network_stats = true;
+    config->show_process_count = true;
+    config->show_context_switches = true;
+    config->show_socket_stats = true;
+    config->show_numa_stats = true;
+    config->interval = DEFAULT_INTERVAL;
+    config->max_series = SERIES_DEFAULT_CAPACITY;
+    config->adaptive = false;
+    config->max_interval = DEFAULT_MAX_INTERVAL;
+    config->profile = false;
+    config->rule_count = 0;
+}
+
+/**
+ * @brief Copia una cadena de JSON a un campo de tamaño fijo.
+ *
+ * @return 0 si el elemento es una cadena que entra en el campo, o -1 si no.
+ */
+static int copy_json_string(char* dest, size_t size, const cJSON* item)
+{
+    if (!cJSON_IsString(item) || strlen(item->valuestring) >= size)
+    {
+        return -1;
+    }
+    strcpy(dest, item->valuestring);
+    return 0;
+}
+
+/**
+ * @brief Analiza una regla de alerta de "rules".
+ *
+ * @return 0 en caso de éxito, o -1 si la regla es inválida.
+ */
+static int parse_rule(struct rule_config* rule, const cJSON* json)
+{
+    static const char* const OPS[] = {[RULE_GT] = ">", [RULE_GE] = ">=", [RULE_LT] = "<",
+                                      [RULE_LE] = "<=", [RULE_EQ] = "==", [RULE_NE] = "!="};
+
+    memset(rule, 0, sizeof(*rule));
+    if (copy_json_string(rule->name, sizeof(rule->name), cJSON_GetObjectItemCaseSensitive(json, "name")) != 0 ||
+        copy_json_string(rule->metric, sizeof(rule->metric), cJSON_GetObjectItemCaseSensitive(json, "metric")) != 0)
+    {
+        fprintf(stderr, "Cada regla necesita \"name\" y \"metric\" de hasta %d y %d caracteres\n",
+                CONFIG_RULE_NAME_SIZE - 1, CONFIG_RULE_METRIC_SIZE - 1);
+        return -1;
+    }
+
+    const cJSON* threshold = cJSON_GetObjectItemCaseSensitive(json, "threshold");
+    if (!cJSON_IsNumber(threshold))
+    {
+        fprintf(stderr, "Regla %s: falta \"threshold\"\n", rule->name);
+        return -1;
+    }
+    rule->threshold = threshold->valuedouble;
+
+    const cJSON* op = cJSON_GetObjectItemCaseSensitive(json, "op");
+    rule->op = RULE_GT;
+    if (op != NULL)
+    {
+        size_t i = 0;
+        while (i < sizeof(OPS) / sizeof(OPS[0]) && !(cJSON_IsString(op) && strcmp(op->valuestring, OPS[i]) == 0))
+        {
+            i++;
+        }
+        if (i == sizeof(OPS) / sizeof(OPS[0]))
+        {
+            fprintf(stderr, "Regla %s: \"op\" debe ser >, >=, <, <=, == o !=\n", rule->name);
+            return -1;
+        }
+        rule->op = (enum rule_op)i;
+    }
+
+    const cJSON* rate = cJSON_GetObjectItemCaseSensitive(json, "rate");
+    const cJSON* for_seconds = cJSON_GetObjectItemCaseSensitive(json, "for");
+    if ((rate != NULL && (!cJSON_IsNumber(rate) || rate->valuedouble <= 0)) ||
+        (for_seconds != NULL && (!cJSON_IsNumber(for_seconds) || for_seconds->valuedouble < 0)))
+    {
+        fprintf(stderr, "Regla %s: \"rate\" debe ser positivo y \"for\" no negativo\n", rule->name);
+        return -1;
+    }
+    rule->rate_window = rate != NULL ? rate->valuedouble : 0.0;
+    rule->for_seconds = for_seconds != NULL ? for_seconds->valuedouble : 0.0;
+
+    const cJSON* labels = cJSON_GetObjectItemCaseSensitive(json, "labels");
+    if (labels != NULL)
+    {
+        const cJSON* label;
+        if (!cJSON_IsObject(labels) || cJSON_GetArraySize(labels) > SERIES_MAX_LABELS)
+        {
+            fprintf(stderr, "Regla %s: \"labels\" debe tener hasta %d etiquetas\n", rule->name, SERIES_MAX_LABELS);
+            return -1;
+        }
+        cJSON_ArrayForEach(label, labels)
+        {
+            if (strlen(label->string) >= SERIES_LABEL_SIZE ||
+                copy_json_string(rule->label_values[rule->label_count], SERIES_LABEL_SIZE, label) != 0)
+            {
+                fprintf(stderr, "Regla %s: etiqueta inválida %s\n", rule->name, label->string);
+                return -1;
+            }
+            strcpy(rule->label_keys[rule->label_count], label->string);
+            rule->label_count++;
+        }
+    }
+
+    const cJSON* webhook = cJSON_GetObjectItemCaseSensitive(json, "webhook");
+    const cJSON* exec = cJSON_GetObjectItemCaseSensitive(json, "exec");
+    if ((webhook != NULL && (copy_json_string(rule->webhook, sizeof(rule->webhook), webhook) != 0 ||
+                             strncmp(rule->webhook, "http://", 7) != 0)) ||
+        (exec != NULL && (copy_json_string(rule->exec, sizeof(rule->exec), exec) != 0 || rule->exec[0] != '/')))
+    {
+        fprintf(stderr, "Regla %s: \"webhook\" debe ser una URL http:// y \"exec\" una ruta absoluta\n", rule->name);
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * @brief Lee el archivo de configuración y lo analiza en una estructura nueva.
+ *
+ * El contenido del archivo y el árbol de cJSON se guardan en la arena de configuración, que se
+ * vacía al comenzar cada lectura: recargar la configuración no usa el heap.
+ *
+ * @param config Estructura a completar; sólo es válida si la función devuelve 0.
+ * @return 0 en caso de éxito, o -1 si el archivo no se pudo leer o es inválido.
+ */
+static int parse_config(struct config* config)
+{
+    // Lo reservado en la lectura anterior se descarta de una vez
+    arena_reset(&config_arena);
+
+    int fd = open(config_path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+    {
+        perror("Error al abrir el archivo de configuración");
+        return -1;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0)
+    {
+        perror("Error al leer el archivo de configuración");
+        close(fd);
+        return -1;
+    }
+
+    size_t length = (size_t)st.st_size;
+    char* data = arena_alloc(&config_arena, length + 1);
+    if (data == NULL)
+    {
+        fprintf(stderr, "El archivo de configuración no entra en %d bytes\n", CONFIG_ARENA_SIZE);
+        close(fd);
+        return -1;
+    }
+
+    size_t read_bytes = 0;
+    while (read_bytes < length)
+    {
+        ssize_t n = read(fd, data + read_bytes, length - read_bytes);
+        if (n < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (n <= 0)
+        {
+            break;
+        }
+        read_bytes += n;
+    }
+    close(fd);
+
+    if (read_bytes != length)
+    {
+        fprintf(stderr, "Error al leer el archivo de configuración (%zu de %zu bytes)\n", read_bytes, length);
+        return -1;
+    }
+    data[length] = '\0';
+
+    cJSON* json = cJSON_Parse(data);
+    if (json == NULL)
+    {
+        if (config_arena.exhausted)
+        {
+            fprintf(stderr, "La configuración no entra en %d bytes\n", CONFIG_ARENA_SIZE);
+        }
+        else
+        {
+            fprintf(stderr, "Error al parsear el archivo JSON\n");
+        }
+        return -1;
+    }
+
+    cJSON* metrics_json = cJSON_GetObjectItemCaseSensitive(json, "metrics");
+    cJSON* interval_json = cJSON_GetObjectItemCaseSensitive(json, "interval");
+
+    if (!cJSON_IsObject(metrics_json) || !cJSON_IsNumber(interval_json))
+    {
+        fprintf(stderr, "Formato de archivo JSON inválido\n");
+        return -1;
+    }
+
+    config->show_cpu_usage = cJSON_IsTrue(cJSON_GetObjectItemCaseSensitive(metrics_json, "cpu"));
+    config->show_memory_usage = cJSON_IsTrue(cJSON_GetObjectItemCaseSensitive(metrics_json, "memory"));
+    config->show_disk_io = cJSON_IsTrue(cJSON_GetObjectItemCaseSensitive(metrics_json, "disk_io"));
+    config->show_network_stats = cJSON_IsTrue(cJSON_GetObjectItemCaseSensitive(metrics_json, "network_stats"));
+    config->show_process_count = cJSON_IsTrue(cJSON_GetObjectItemCaseSensitive(metrics_json, "process_count"));
+    config->show_context_switches =
+        cJSON_IsTrue(cJSON_GetObjectItemCaseSensitive(metrics_json, "context_switches"));
+    config->show_socket_stats = cJSON_IsTrue(cJSON_GetObjectItemCaseSensitive(metrics_json, "socket_stats"));
+    config->show_numa_stats = cJSON_IsTrue(cJSON_GetObjectItemCaseSensitive(metrics_json, "numa"));
+
+    config->interval = interval_json->valueint;
+    if (config->interval < 1)
+    {
+        fprintf(stderr, "El intervalo debe ser de al menos 1 segundo\n");
+        return -1;
+    }
+
+    config->max_series = SERIES_DEFAULT_CAPACITY;
+    cJSON* max_series_json = cJSON_GetObjectItemCaseSensitive(json, "max_series");
+    if (cJSON_IsNumber(max_series_json) && max_series_json->valuedouble >= 1)
+    {
+        config->max_series = (size_t)max_series_json->valuedouble;
+    }
+
+    config->adaptive = cJSON_IsTrue(cJSON_GetObjectItemCaseSensitive(json, "adaptive"));
+    config->profile = cJSON_IsTrue(cJSON_GetObjectItemCaseSensitive(json, "profile"));
+    config->max_interval = config->interval > DEFAULT_MAX_INTERVAL ? config->interval : DEFAULT_MAX_INTERVAL;
+    cJSON* max_interval_json = cJSON_GetObjectItemCaseSensitive(json, "max_interval");
+    if (cJSON_IsNumber(max_interval_json))
+    {
+        config->max_interval = max_interval_json->valueint;
+        if (config->max_interval < config->interval)
+        {
+            fprintf(stderr, "max_interval no puede ser menor que el intervalo\n");
+            return -1;
+        }
+    }
+
+    config->rule_count = 0;
+    cJSON* rules_json = cJSON_GetObjectItemCaseSensitive(json, "rules");
+    if (rules_json != NULL)
+    {
+        cJSON* rule_json;
+        if (!cJSON_IsArray(rules_json) || cJSON_GetArraySize(rules_json) > CONFIG_MAX_RULES)
+        {
+            fprintf(stderr, "\"rules\" debe ser un arreglo de hasta %d reglas\n", CONFIG_MAX_RULES);
+            return -1;
+        }
+        cJSON_ArrayForEach(rule_json, rules_json)
+        {
+            if (parse_rule(&config->rules[config->rule_count], rule_json) != 0)
+            {
+                return -1;
+            }
+            for (size_t i = 0; i < config->rule_count; i++)
+            {
+                if (strcmp(config->rules[i].name, config->rules[config->rule_count].name) == 0)
+                {
+                    fprintf(stderr, "Regla duplicada: %s\n", config->rules[i].name);
+                    return -1;
+                }
+            }
+            config->rule_count++;
+        }
+    }
+
+    // No hace falta cJSON_Delete(): el árbol vive en la arena hasta la próxima lectura
+    return 0;
+}
+
+/**
+ * @brief Copia una configuración a un lugar libre, la publica y despierta al planificador.
+ *
+ * Sólo la llama un hilo a la vez (el arranque o el de recarga).
+ */
+static void publish_config(const struct config* config)
+{
+    struct config* current = atomic_load(&published);
+    struct config* reader = atomic_load(&in_use);
+
+    // Con CONFIG_SLOTS lugares siempre hay uno que no es el publicado ni el que usa el planificador
+    struct config* slot = NULL;
+    for (size_t i = 0; i < CONFIG_SLOTS && slot == NULL; i++)
+    {
+        if (&slots[i] != current && &slots[i] != reader)
+        {
+            slot = &slots[i];
+        }
+    }
+
+    *slot = *config;
+    atomic_store(&published, slot);
+
+    uint64_t one = 1;
+    if (write(wake_fd, &one, sizeof(one)) < 0 && errno != EAGAIN)
+    {
+        perror("Error al despertar al planificador");
+    }
+}
+
+int config_init(const char* path)
+{
+    if (strlen(path) >= sizeof(config_path))
+    {
+        fprintf(stderr, "Ruta de configuración demasiado larga: %s\n", path);
+        return -1;
+    }
+    strcpy(config_path, path);
+
+    // inotify vigila el directorio: los editores suelen reemplazar el archivo en lugar de escribirlo
+    strcpy(config_dir, path);
+    char* slash = strrchr(config_dir, '/');
+    if (slash == NULL)
+    {
+        strcpy(config_dir, ".");
+        config_name = config_path;
+    }
+    else
+    {
+        config_name = config_path + (slash - config_dir) + 1;
+        if (slash == config_dir)
+        {
+            slash++; // El archivo está en "/"
+        }
+        *slash = '\0';
+    }
+
+    wake_fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (wake_fd < 0)
+    {
+        perror("Error al crear el eventfd de configuración");
+        return -1;
+    }
+
+    // cJSON reserva sus nodos en la arena de configuración
+    if (arena_init(&config_arena, CONFIG_ARENA_SIZE) != 0)
+    {
+        return -1;
+    }
+    cJSON_Hooks hooks = {.malloc_fn = config_malloc, .free_fn = config_free};
+    cJSON_InitHooks(&hooks);
+
+    struct config config;
+    if (parse_config(&config) != 0)
+    {
+        fprintf(stderr, "Usando métricas por defecto\n");
+        default_config(&config);
+    }
+    publish_config(&config);
+    return 0;
+}
+
+/**
+ * @brief Vuelve a leer el archivo y publica la configuración nueva.
+ *
+ * Si el archivo es inválido (p. ej. a medio guardar) se conserva la configuración anterior.
+ */
+static void reload_config(void)
+{
+    struct config config;
+    if (parse_config(&config) != 0)
+    {
+        fprintf(stderr, "Se conserva la configuración anterior\n");
+        return;
+    }
+    publish_config(&config);
+    fprintf(stderr, "Configuración recargada desde %s\n", config_path);
+}
+
+/**
+ * @brief Indica si un lote de eventos de inotify incluye el archivo de configuración.
+ */
+static bool config_file_changed(const char* events, ssize_t len)
+{
+    bool changed = false;
+    for (ssize_t offset = 0; offset < len;)
+    {
+        const struct inotify_event* event = (const struct inotify_event*)(events + offset);
+        if (event->len > 0 && strcmp(event->name, config_name) == 0)
+        {
+            changed = true;
+        }
+        offset += sizeof(struct inotify_event) + event->len;
+    }
+    return changed;
+}
+
+/**
+ * @brief Función del hilo de recarga: espera cambios del archivo o SIGUSR1 y publica la configuración.
+ */
+static void* watch_config(void* arg)
+{
+    int* fds = arg;
+    struct pollfd poll_fds[2] = {{.fd = fds[0], .events = POLLIN}, {.fd = fds[1], .events = POLLIN}};
+    static char events[INOTIFY_BUFFER_SIZE] __attribute__((aligned(__alignof__(struct inotify_event))));
+
+    while (1)
+    {
+        if (poll(poll_fds, 2, -1) < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            perror("Error al esperar cambios de configuración");
+            return NULL;
+        }
+
+        bool reload = false;
+        if (poll_fds[0].fd >= 0 && (poll_fds[0].revents & POLLIN))
+        {
+            ssize_t len = read(poll_fds[0].fd, events, sizeof(events));
+            reload = len > 0 && config_file_changed(events, len);
+        }
+        if (poll_fds[1].revents & POLLIN)
+        {
+            struct signalfd_siginfo info;
+            reload = read(poll_fds[1].fd, &info, sizeof(info)) == sizeof(info) || reload;
+        }
+
+        if (reload)
+        {
+            reload_config();
+        }
+    }
+
+    return NULL;
+}
+
+int config_watch(void)
+{
+    static int fds[2];
+
+    sigset_t mask;
+    sigemptyset(&mask);
+    sigaddset(&mask, SIGUSR1);
+    fds[1] = signalfd(-1, &mask, SFD_CLOEXEC);
+    if (fds[1] < 0)
+    {
+        perror("Error al crear el signalfd de SIGUSR1");
+        return -1;
+    }
+
+    // Sin inotify (p. ej. límite de watches alcanzado) la recarga sigue funcionando con SIGUSR1
+    fds[0] = inotify_init1(IN_CLOEXEC);
+    if (fds[0] >= 0 && inotify_add_watch(fds[0], config_dir, IN_CLOSE_WRITE | IN_MOVED_TO) < 0)
+    {
+        close(fds[0]);
+        fds[0] = -1;
+    }
+    if (fds[0] < 0)
+    {
+        perror("No se pudo vigilar el archivo de configuración, sólo se recargará con SIGUSR1");
+    }
+
+    pthread_t tid;
+    if (pthread_create(&tid, NULL, watch_config, fds) != 0)
+    {
+        fprintf(stderr, "Error al crear el hilo de recarga de configuración\n");
+        return -1;
+    }
+    pthread_detach(tid);
+    return 0;
+}
+
+const struct config* config_acquire(void)
+{
+    // Primero se descarta el aviso pendiente: una publicación posterior vuelve a despertar la espera
+    uint64_t count;
+    while (read(wake_fd, &count, sizeof(count)) < 0 && errno == EINTR)
+    {
+    }
+
+    // Se anuncia la configuración tomada y se comprueba que siga publicada; si no, el hilo de
+    // recarga podría haber elegido su lugar antes de ver el anuncio
+    struct config* config;
+    do
+    {
+        config = atomic_load(&published);
+        atomic_store(&in_use, config);
+    } while (atomic_load(&published) != config);
+
+    return config;
+}
+
+int config_wake_fd(void)
+{
+    return wake_fd;
+}
@@ -1,41 +1,277 @@
 #include "../include/expose_metrics.h"
+#include <stdatomic.h>
+#include <stddef.h>
+#include <strings.h>
+#include <time.h>
 
-#define HTTP_PORT 8000
 #define SLEEP_DURATION 1
+#define TEXT_CONTENT_TYPE "text/plain; version=0.0.4; charset=utf-8"
+#define OPENMETRICS_CONTENT_TYPE "application/openmetrics-text; version=1.0.0; charset=utf-8"
+#define PROTOBUF_CONTENT_TYPE \
+    "application/vnd.google.protobuf; proto=io.prometheus.client.MetricFamily; encoding=delimited"
+#define MAX_INTERFACES 1024
+#define MAX_DISK_DEVICES 1024
+#define LABEL_NUMBER_SIZE 12
+#define PROFILE_RESPONSE_SIZE 4096
+#define EXPOSITION_SLOTS 2
 
 /** Mutex para sincronización de hilos */
 pthread_mutex_t lock;
 
+/**
+ * @brief Formatos de exposición, elegidos según el encabezado Accept del scrape.
+ */
+enum exposition_format
+{
+    EXPOSITION_TEXT,        /**< Formato de texto de Prometheus 0.0.4. */
+    EXPOSITION_OPENMETRICS, /**< OpenMetrics 1.0.0. */
+    EXPOSITION_PROTOBUF,    /**< MetricFamily de Prometheus en protobuf delimitado. */
+    EXPOSITION_FORMAT_COUNT
+};
+
+/**
+ * @brief Buffer de una exposición que MHD envía sin copiarlo.
+ *
+ * Mientras alguna respuesta creada sobre el buffer siga viva (la de la caché o una que todavía se
+ * está enviando a un scraper lento), el buffer está ocupado y no se vuelve a generar encima.
+ */
+struct exposition_slot
+{
+    struct series_buffer buffer; /**< Exposición generada; sólo crece mientras está libre. */
+    atomic_bool busy;            /**< Hay una respuesta de MHD que apunta a buffer. */
+};
+
+/**
+ * @brief Estado de un formato: buffers reutilizados entre scrapes y respuesta de la última versión.
+ *
+ * Todo está protegido por lock, salvo busy, que MHD libera desde su hilo al destruir la
+ * respuesta. Las series observadas se generan en observed sólo cuando cambia series_version();
+ * cada respuesta es esa parte seguida de la contabilidad del agente, generada de nuevo cada vez que
+ * cambia series_self_version(), es decir, a lo sumo una vez por ciclo. La respuesta se reutiliza
+ * mientras no cambie ninguna de las dos versiones.
+ */
+struct exposition
+{
+    const char* content_type;                                   /**< Valor del encabezado Content-Type. */
+    int (*render)(struct series_buffer*, enum series_part);     /**< Genera el formato desde la tabla. */
+    struct series_buffer observed;                              /**< Series observadas, sin las del agente. */
+    bool observed_ready;                                        /**< observed corresponde a cached_version. */
+    struct exposition_slot slots[EXPOSITION_SLOTS];             /**< Doble buffer de la exposición. */
+    struct MHD_Response* cached_response;                       /**< Respuesta de las versiones guardadas. */
+    unsigned long long cached_version;                          /**< series_version() de observed. */
+    unsigned long long cached_self_version;                     /**< series_self_version() de la respuesta. */
+    const char* profile_name;                                   /**< Sección de /debug/profile de sus scrapes. */
+    int profile_section;                                        /**< Identificador de esa sección. */
+};
+
+static struct exposition expositions[EXPOSITION_FORMAT_COUNT] = {
+    [EXPOSITION_TEXT] = {.content_type = TEXT_CONTENT_TYPE,
+                         .render = series_render_text,
+                         .profile_name = "scrape_text",
+                         .profile_section = -1},
+    [EXPOSITION_OPENMETRICS] = {.content_type = OPENMETRICS_CONTENT_TYPE,
+                                .render = series_render_openmetrics,
+                                .profile_name = "scrape_openmetrics",
+                                .profile_section = -1},
+    [EXPOSITION_PROTOBUF] = {.content_type = PROTOBUF_CONTENT_TYPE,
+                             .render = series_render_protobuf,
+                             .profile_name = "scrape_protobuf",
+                             .profile_section = -1},
+};
+
 /** Métrica de Prometheus para el uso de CPU */
-static prom_gauge_t* cpu_usage_metric;
+static int cpu_usage_metric;
 
 /** Métrica de Prometheus para el uso de memoria */
-static prom_gauge_t* memory_usage_metric;
+static int memory_usage_metric;
 
 // Declaraciones de métricas
-static prom_gauge_t* memory_total_metric;
-static prom_gauge_t* memory_used_metric;
-static prom_gauge_t* memory_free_metric;
-static prom_gauge_t* process_count_metric;
-static prom_gauge_t* context_switches_metric;
-static prom_gauge_t* disk_read_metric;
-static prom_gauge_t* disk_write_metric;
-static prom_gauge_t* network_rx_metric;
-static prom_gauge_t* network_tx_metric;
-
-void update_cpu_gauge()
+static int memory_total_metric;
+static int memory_used_metric;
+static int memory_free_metric;
+static int process_count_metric;
+static int context_switches_metric;
+static int disk_read_metric;
+static int disk_write_metric;
+static int network_rx_metric;
+static int network_tx_metric;
+
+/** Métricas por interfaz y por dispositivo; pueden aparecer y desaparecer */
+static int network_interface_rx_metric;
+static int network_interface_tx_metric;
+static int disk_device_read_metric;
+static int disk_device_write_metric;
+
+/** Uso de CPU por núcleo, etiquetado con su nodo NUMA y socket */
+static int cpu_core_usage_metric;
+
+/** Cambios de topología detectados (hotplug de CPUs o de memoria) */
+static int numa_topology_changes_metric;
+
+/** Métricas propias de la tabla de series */
+static int series_active_metric;
+static int series_capacity_metric;
+static int series_evictions_metric;
+static int series_stale_metric;
+
+/** Métricas propias del ciclo de recolección */
+static int tick_duration_metric;
+static int tick_jitter_metric;
+
+/** Estado de las reglas de alerta y resultado de sus acciones */
+static int rule_state_metric;
+static int rule_value_metric;
+static int rule_firing_metric;
+static int rule_actions_metric;
+
+/** Intervalo actual y ejecuciones de cada colector */
+static int collector_interval_metric;
+static int collector_runs_metric;
+
+/** Métricas de sockets por estado y por bucket de cola, con etiquetas */
+static int tcp_sockets_metric;
+static int udp_sockets_metric;
+static int socket_recv_queue_metric;
+static int socket_send_queue_metric;
+static int socket_accept_queue_metric;
+
+/** Etiquetas "le" de los buckets de cola, calculadas una sola vez en init_metrics() */
+static char queue_bucket_labels[SOCK_QUEUE_BUCKETS][24];
+
+/**
+ * @brief Valor de protocolo de /proc/net/snmp o /proc/net/netstat, tomado de struct net_proto_stats.
+ *
+ * Todos son contadores que el kernel acumula desde el arranque, salvo tcp_curr_estab.
+ */
+struct proto_metric
+{
+    const char* name;      /**< Nombre de la métrica. */
+    const char* help;      /**< Descripción de la métrica. */
+    enum series_type type; /**< Tipo de la métrica. */
+    size_t offset;         /**< Desplazamiento del valor en struct net_proto_stats. */
+    int family;            /**< Familia creada en init_metrics(). */
+};
+
+static struct proto_metric proto_metrics[] = {
+    {"tcp_active_opens_total", "TCP Active Opens", SERIES_COUNTER,
+     offsetof(struct net_proto_stats, tcp_active_opens), -1},
+    {"tcp_passive_opens_total", "TCP Passive Opens", SERIES_COUNTER,
+     offsetof(struct net_proto_stats, tcp_passive_opens), -1},
+    {"tcp_attempt_fails_total", "TCP Attempt Fails", SERIES_COUNTER,
+     offsetof(struct net_proto_stats, tcp_attempt_fails), -1},
+    {"tcp_estab_resets_total", "TCP Established Resets", SERIES_COUNTER,
+     offsetof(struct net_proto_stats, tcp_estab_resets), -1},
+    {"tcp_curr_estab", "TCP Currently Established", SERIES_GAUGE, offsetof(struct net_proto_stats, tcp_curr_estab), -1},
+    {"tcp_in_segs_total", "TCP Segments Received", SERIES_COUNTER, offsetof(struct net_proto_stats, tcp_in_segs), -1},
+    {"tcp_out_segs_total", "TCP Segments Sent", SERIES_COUNTER, offsetof(struct net_proto_stats, tcp_out_segs), -1},
+    {"tcp_retrans_segs_total", "TCP Retransmitted Segments", SERIES_COUNTER,
+     offsetof(struct net_proto_stats, tcp_retrans_segs), -1},
+    {"tcp_in_errs_total", "TCP Segments Received With Errors", SERIES_COUNTER,
+     offsetof(struct net_proto_stats, tcp_in_errs), -1},
+    {"tcp_out_rsts_total", "TCP RST Segments Sent", SERIES_COUNTER, offsetof(struct net_proto_stats, tcp_out_rsts), -1},
+    {"tcp_listen_overflows_total", "TCP Listen Queue Overflows", SERIES_COUNTER,
+     offsetof(struct net_proto_stats, tcp_listen_overflows), -1},
+    {"tcp_listen_drops_total", "TCP Listen Drops", SERIES_COUNTER,
+     offsetof(struct net_proto_stats, tcp_listen_drops), -1},
+    {"tcp_timeouts_total", "TCP Retransmission Timeouts", SERIES_COUNTER,
+     offsetof(struct net_proto_stats, tcp_timeouts), -1},
+    {"tcp_syn_retrans_total", "TCP SYN Retransmits", SERIES_COUNTER,
+     offsetof(struct net_proto_stats, tcp_syn_retrans), -1},
+    {"udp_in_datagrams_total", "UDP Datagrams Received", SERIES_COUNTER,
+     offsetof(struct net_proto_stats, udp_in_datagrams), -1},
+    {"udp_out_datagrams_total", "UDP Datagrams Sent", SERIES_COUNTER,
+     offsetof(struct net_proto_stats, udp_out_datagrams), -1},
+    {"udp_no_ports_total", "UDP Datagrams To Unknown Port", SERIES_COUNTER,
+     offsetof(struct net_proto_stats, udp_no_ports), -1},
+    {"udp_in_errors_total", "UDP Receive Errors", SERIES_COUNTER, offsetof(struct net_proto_stats, udp_in_errors), -1},
+    {"udp_rcvbuf_errors_total", "UDP Receive Buffer Errors", SERIES_COUNTER,
+     offsetof(struct net_proto_stats, udp_rcvbuf_errors), -1},
+    {"udp_sndbuf_errors_total", "UDP Send Buffer Errors", SERIES_COUNTER,
+     offsetof(struct net_proto_stats, udp_sndbuf_errors), -1},
+};
+
+#define PROTO_METRIC_COUNT (sizeof(proto_metrics) / sizeof(proto_metrics[0]))
+
+/**
+ * @brief Valor de un nodo NUMA expuesto con la etiqueta "node", tomado de struct numa_node_stats.
+ */
+struct numa_metric
+{
+    const char* name;      /**< Nombre de la métrica. */
+    const char* help;      /**< Descripción de la métrica. */
+    enum series_type type; /**< Tipo de la métrica. */
+    size_t offset;         /**< Desplazamiento del valor en struct numa_node_stats. */
+    int family;            /**< Familia creada en init_metrics(). */
+};
+
+static struct numa_metric numa_metrics[] = {
+    {"numa_node_memory_total_bytes", "NUMA Node Total Memory", SERIES_GAUGE,
+     offsetof(struct numa_node_stats, mem_total), -1},
+    {"numa_node_memory_free_bytes", "NUMA Node Free Memory", SERIES_GAUGE, offsetof(struct numa_node_stats, mem_free),
+     -1},
+    {"numa_node_memory_used_bytes", "NUMA Node Used Memory", SERIES_GAUGE, offsetof(struct numa_node_stats, mem_used),
+     -1},
+    {"numa_node_file_pages_bytes", "NUMA Node Page Cache", SERIES_GAUGE, offsetof(struct numa_node_stats, file_pages),
+     -1},
+    {"numa_node_anon_pages_bytes", "NUMA Node Anonymous Memory", SERIES_GAUGE,
+     offsetof(struct numa_node_stats, anon_pages), -1},
+    {"numa_node_hit_total", "Pages Allocated On The Intended Node", SERIES_COUNTER,
+     offsetof(struct numa_node_stats, numa_hit), -1},
+    {"numa_node_miss_total", "Pages Allocated On This Node Intended For Another", SERIES_COUNTER,
+     offsetof(struct numa_node_stats, numa_miss), -1},
+    {"numa_node_foreign_total", "Pages Intended For This Node Allocated On Another", SERIES_COUNTER,
+     offsetof(struct numa_node_stats, numa_foreign), -1},
+    {"numa_node_interleave_hit_total", "Interleaved Pages Allocated On This Node", SERIES_COUNTER,
+     offsetof(struct numa_node_stats, interleave_hit), -1},
+    {"numa_node_local_total", "Pages Allocated While Running On This Node", SERIES_COUNTER,
+     offsetof(struct numa_node_stats, local_node), -1},
+    {"numa_node_other_total", "Pages Allocated On This Node While Running On Another", SERIES_COUNTER,
+     offsetof(struct numa_node_stats, other_node), -1},
+};
+
+#define NUMA_METRIC_COUNT (sizeof(numa_metrics) / sizeof(numa_metrics[0]))
+
+void update_cpu_gauge(bool per_core)
 {
-    double usage = get_cpu_usage();
+    // Uso por núcleo, etiquetado con la topología en caché para poder agregarlo por nodo o socket
+    static struct cpu_core_usage cores[NUMA_MAX_CPUS];
+    int core_count = -1;
+
+    double usage = get_cpu_usage(per_core ? cores : NULL, NUMA_MAX_CPUS, &core_count);
     if (usage >= 0)
     {
         pthread_mutex_lock(&lock);
-        prom_gauge_set(cpu_usage_metric, usage, NULL);
+        series_set(cpu_usage_metric, NULL, usage);
         pthread_mutex_unlock(&lock);
     }
     else
     {
         fprintf(stderr, "Error al obtener el uso de CPU\n");
     }
+
+    if (!per_core)
+    {
+        return;
+    }
+    if (core_count < 0)
+    {
+        fprintf(stderr, "Error al obtener el uso de CPU por núcleo\n");
+        return;
+    }
+
+    pthread_mutex_lock(&lock);
+    series_sweep_begin(cpu_core_usage_metric);
+    for (int i = 0; i < core_count; i++)
+    {
+        char cpu[LABEL_NUMBER_SIZE], node[LABEL_NUMBER_SIZE], socket[LABEL_NUMBER_SIZE];
+        snprintf(cpu, sizeof(cpu), "%d", cores[i].cpu);
+        snprintf(node, sizeof(node), "%d", cores[i].node);
+        snprintf(socket, sizeof(socket), "%d", cores[i].socket);
+        const char* labels[] = {cpu, node, socket};
+        series_set(cpu_core_usage_metric, labels, cores[i].usage);
+    }
+    series_sweep_end(cpu_core_usage_metric);
+    pthread_mutex_unlock(&lock);
 }
 
 void update_memory_gauge()
@@ -44,7 +280,7 @@ void update_memory_gauge()
     if (usage >= 0)
     {
         pthread_mutex_lock(&lock);
-        prom_gauge_set(memory_usage_metric, usage, NULL);
+        series_set(memory_usage_metric, NULL, usage);
         pthread_mutex_unlock(&lock);
     }
     else
@@ -53,21 +289,321 @@ void update_memory_gauge()
     }
 }
 
-void* expose_metrics(void* arg)
+/**
+ * @brief Compara un fragmento [start, end) de un encabezado con una cadena, sin distinguir mayúsculas.
+ */
+static bool token_equals(const char* start, const char* end, const char* token)
+{
+    size_t len = strlen(token);
+    return (size_t)(end - start) == len && strncasecmp(start, token, len) == 0;
+}
+
+/**
+ * @brief Avanza sobre espacios y tabulaciones.
+ */
+static const char* skip_spaces(const char* p, const char* end)
 {
-    (void)arg; // Argumento no utilizado
+    while (p < end && (*p == ' ' || *p == '\t'))
+    {
+        p++;
+    }
+    return p;
+}
+
+/**
+ * @brief Interpreta un rango de medios del encabezado Accept ("tipo/subtipo; param=valor; q=0.5").
+ *
+ * @param start Comienzo del rango.
+ * @param end Fin del rango (la coma siguiente o el final del encabezado).
+ * @param format Formato que corresponde al rango.
+ * @param q Preferencia del rango (0.0 a 1.0).
+ * @return true si el rango corresponde a alguno de los formatos que se pueden generar.
+ */
+static bool parse_media_range(const char* start, const char* end, enum exposition_format* format, double* q)
+{
+    const char* type_start = skip_spaces(start, end);
+    const char* type_end = type_start;
+    while (type_end < end && *type_end != ';' && *type_end != ' ' && *type_end != '\t')
+    {
+        type_end++;
+    }
 
-    // Aseguramos que el manejador HTTP esté adjunto al registro por defecto
-    promhttp_set_active_collector_registry(NULL);
+    bool protobuf_delimited = false, protobuf_metric_family = false, openmetrics_version = true;
+    *q = 1.0;
 
-    // Iniciamos el servidor HTTP en el puerto definido
-    struct MHD_Daemon* daemon = promhttp_start_daemon(MHD_USE_SELECT_INTERNALLY, HTTP_PORT, NULL, NULL);
-    if (daemon == NULL)
+    for (const char* p = memchr(type_end, ';', end - type_end); p != NULL && p < end;
+         p = memchr(p + 1, ';', end - (p + 1)))
+    {
+        const char* name = skip_spaces(p + 1, end);
+        const char* equals = memchr(name, '=', end - name);
+        if (equals == NULL)
+        {
+            break;
+        }
+        const char* value = skip_spaces(equals + 1, end);
+        const char* value_end = value;
+        while (value_end < end && *value_end != ';' && *value_end != ' ' && *value_end != '\t')
+        {
+            value_end++;
+        }
+
+        if (token_equals(name, equals, "q"))
+        {
+            *q = strtod(value, NULL);
+        }
+        else if (token_equals(name, equals, "encoding"))
+        {
+            protobuf_delimited = token_equals(value, value_end, "delimited");
+        }
+        else if (token_equals(name, equals, "proto"))
+        {
+            protobuf_metric_family = token_equals(value, value_end, "io.prometheus.client.MetricFamily");
+        }
+        else if (token_equals(name, equals, "version"))
+        {
+            openmetrics_version = token_equals(value, value_end, "1.0.0") || token_equals(value, value_end, "0.0.1");
+        }
+    }
+
+    if (token_equals(type_start, type_end, "application/vnd.google.protobuf"))
+    {
+        *format = EXPOSITION_PROTOBUF;
+        return protobuf_delimited && protobuf_metric_family;
+    }
+    if (token_equals(type_start, type_end, "application/openmetrics-text"))
+    {
+        *format = EXPOSITION_OPENMETRICS;
+        return openmetrics_version;
+    }
+    *format = EXPOSITION_TEXT;
+    return token_equals(type_start, type_end, "text/plain") || token_equals(type_start, type_end, "text/*") ||
+           token_equals(type_start, type_end, "*/*");
+}
+
+/**
+ * @brief Elige el formato de exposición según el encabezado Accept.
+ *
+ * Gana el rango con mayor q; entre rangos con igual q, el primero. Sin encabezado, o si ningún
+ * rango corresponde a un formato conocido, se usa el formato de texto.
+ */
+static enum exposition_format negotiate_format(const char* accept)
+{
+    enum exposition_format best = EXPOSITION_TEXT;
+    double best_q = 0.0;
+
+    if (accept == NULL)
+    {
+        return EXPOSITION_TEXT;
+    }
+
+    const char* end = accept + strlen(accept);
+    for (const char* start = accept; start < end;)
+    {
+        const char* comma = memchr(start, ',', end - start);
+        const char* range_end = comma != NULL ? comma : end;
+
+        enum exposition_format format;
+        double q;
+        if (parse_media_range(start, range_end, &format, &q) && q > best_q)
+        {
+            best = format;
+            best_q = q;
+        }
+        start = range_end + 1;
+    }
+    return best;
+}
+
+/**
+ * @brief Atiende GET /debug/profile: el costo acumulado de cada sección del agente.
+ */
+static enum MHD_Result handle_profile_request(struct MHD_Connection* connection)
+{
+    static const char disabled[] = "Perfilado desactivado: agregar \"profile\": true a la configuración\n";
+    char text[PROFILE_RESPONSE_SIZE];
+    unsigned int status = MHD_HTTP_OK;
+    struct MHD_Response* response;
+
+    if (self_profile_enabled())
+    {
+        size_t len = self_profile_render(text, sizeof(text));
+        response = MHD_create_response_from_buffer(len, text, MHD_RESPMEM_MUST_COPY);
+    }
+    else
+    {
+        status = MHD_HTTP_NOT_FOUND;
+        response = MHD_create_response_from_buffer(sizeof(disabled) - 1, (void*)disabled, MHD_RESPMEM_PERSISTENT);
+    }
+    if (response == NULL)
+    {
+        return MHD_NO;
+    }
+
+    MHD_add_response_header(response, MHD_HTTP_HEADER_CONTENT_TYPE, "text/plain; charset=utf-8");
+    enum MHD_Result ret = MHD_queue_response(connection, status, response);
+    MHD_destroy_response(response);
+    return ret;
+}
+
+/**
+ * @brief Libera el buffer de una respuesta: MHD la llama al destruir la respuesta.
+ *
+ * @param data Buffer de la respuesta (el de un slot, o uno propio de la respuesta).
+ */
+static void release_exposition(void* data)
+{
+    for (int format = 0; format < EXPOSITION_FORMAT_COUNT; format++)
+    {
+        for (int s = 0; s < EXPOSITION_SLOTS; s++)
+        {
+            struct exposition_slot* slot = &expositions[format].slots[s];
+            // Los slots sólo se generan desde el hilo de MHD, el mismo que destruye las respuestas
+            if (slot->buffer.data == data)
+            {
+                atomic_store(&slot->busy, false);
+                return;
+            }
+        }
+    }
+    free(data);
+}
+
+/**
+ * @brief Genera la exposición de un formato y crea su respuesta sin copiar el buffer.
+ *
+ * Las series observadas se regeneran sólo si cambió la versión de la tabla; la respuesta las copia
+ * y agrega la contabilidad del agente. Se compone en un slot libre; la respuesta anterior mantiene
+ * ocupado el otro hasta que MHD termina de enviarla. Si ambos siguen ocupados (un scraper lento
+ * retiene una versión vieja), se compone en un buffer propio de la respuesta, que MHD libera con ella.
+ * Debe llamarse con el mutex tomado.
+ *
+ * @param table_version Valor actual de series_version().
+ * @return Respuesta nueva, o NULL en caso de error.
+ */
+static struct MHD_Response* build_exposition_response(struct exposition* exposition, unsigned long long table_version)
+{
+    if (!exposition->observed_ready || exposition->cached_version != table_version)
+    {
+        exposition->observed_ready = exposition->render(&exposition->observed, SERIES_PART_OBSERVED) == 0;
+        if (!exposition->observed_ready)
+        {
+            return NULL;
+        }
+        exposition->cached_version = table_version;
+    }
+
+    struct exposition_slot* slot = NULL;
+    for (int s = 0; s < EXPOSITION_SLOTS && slot == NULL; s++)
+    {
+        if (!atomic_load(&exposition->slots[s].busy))
+        {
+            slot = &exposition->slots[s];
+        }
+    }
+
+    struct series_buffer overflow = {NULL, 0, 0};
+    struct series_buffer* buffer = slot != NULL ? &slot->buffer : &overflow;
+    if (series_buffer_copy(buffer, &exposition->observed) != 0 || exposition->render(buffer, SERIES_PART_SELF) != 0)
+    {
+        free(overflow.data);
+        return NULL;
+    }
+
+    if (slot != NULL)
     {
-        fprintf(stderr, "Error al iniciar el servidor HTTP\n");
+        atomic_store(&slot->busy, true);
+    }
+    struct MHD_Response* response =
+        MHD_create_response_from_buffer_with_free_callback(buffer->len, buffer->data, release_exposition);
+    if (response == NULL)
+    {
+        release_exposition(buffer->data);
         return NULL;
     }
 
+    MHD_add_response_header(response, MHD_HTTP_HEADER_CONTENT_TYPE, exposition->content_type);
+    MHD_add_response_header(response, MHD_HTTP_HEADER_VARY, MHD_HTTP_HEADER_ACCEPT);
+    return response;
+}
+
+/**
+ * @brief Atiende una petición HTTP: GET /metrics devuelve las series activas en el formato pedido.
+ */
+static enum MHD_Result handle_request(void* cls, struct MHD_Connection* connection, const char* url,
+                                      const char* method, const char* version, const char* upload_data,
+                                      size_t* upload_data_size, void** con_cls)
+{
+    (void)cls;
+    (void)version;
+    (void)upload_data;
+    (void)upload_data_size;
+    (void)con_cls;
+
+    static const char bad_request[] = "Bad Request\n";
+    if (strcmp(method, MHD_HTTP_METHOD_GET) == 0 && strcmp(url, "/debug/profile") == 0)
+    {
+        return handle_profile_request(connection);
+    }
+    if (strcmp(method, MHD_HTTP_METHOD_GET) != 0 || strcmp(url, "/metrics") != 0)
+    {
+        struct MHD_Response* response =
+            MHD_create_response_from_buffer(sizeof(bad_request) - 1, (void*)bad_request, MHD_RESPMEM_PERSISTENT);
+        enum MHD_Result ret = MHD_queue_response(connection, MHD_HTTP_BAD_REQUEST, response);
+        MHD_destroy_response(response);
+        return ret;
+    }
+
+    // El costo del scrape (negociación, espera del mutex y generación) se atribuye a su formato
+    struct self_profile_sample profile_start;
+    self_profile_begin(&profile_start);
+
+    struct exposition* exposition =
+        &expositions[negotiate_format(MHD_lookup_connection_value(connection, MHD_HEADER_KIND, MHD_HTTP_HEADER_ACCEPT))];
+
+    // Entre ciclos la tabla no cambia y todos los scrapes de un mismo formato comparten la misma
+    // respuesta; sólo se compone cuando cambió alguna de las versiones, y MHD envía el buffer sin copiarlo
+    pthread_mutex_lock(&lock);
+    unsigned long long table_version = series_version();
+    unsigned long long self_version = series_self_version();
+    if (exposition->cached_response == NULL || table_version != exposition->cached_version ||
+        self_version != exposition->cached_self_version)
+    {
+        struct MHD_Response* response = build_exposition_response(exposition, table_version);
+        if (response != NULL)
+        {
+            if (exposition->cached_response != NULL)
+            {
+                MHD_destroy_response(exposition->cached_response);
+            }
+            exposition->cached_response = response;
+            exposition->cached_self_version = self_version;
+        }
+    }
+
+    // MHD toma su propia referencia: la respuesta sigue siendo válida aunque se reemplace
+    enum MHD_Result ret = MHD_NO;
+    if (exposition->cached_response != NULL)
+    {
+        ret = MHD_queue_response(connection, MHD_HTTP_OK, exposition->cached_response);
+    }
+    pthread_mutex_unlock(&lock);
+    self_profile_end(exposition->profile_section, &profile_start);
+    return ret;
+}
+
+void* expose_metrics(void* arg)
+{
+    int port = *(const int*)arg;
+
+    // Iniciamos el servidor HTTP en el puerto indicado
+    struct MHD_Daemon* daemon = MHD_start_daemon(MHD_USE_SELECT_INTERNALLY, (uint16_t)port, NULL, NULL, handle_request,
+                                                 NULL, MHD_OPTION_END);
+    if (daemon == NULL)
+    {
+        fprintf(stderr, "Error al iniciar el servidor HTTP en el puerto %d\n", port);
+        exit(EXIT_FAILURE);
+    }
+
     // Mantenemos el servidor en ejecución
     while (1)
     {
@@ -88,9 +624,9 @@ void update_memory_gauge2()
     if (total_mem >= 0 && used_mem >= 0 && free_mem >= 0)
     {
         pthread_mutex_lock(&lock);
-        prom_gauge_set(memory_total_metric, total_mem, NULL);
-        prom_gauge_set(memory_used_metric, used_mem, NULL);
-        prom_gauge_set(memory_free_metric, free_mem, NULL);
+        series_set(memory_total_metric, NULL, total_mem);
+        series_set(memory_used_metric, NULL, used_mem);
+        series_set(memory_free_metric, NULL, free_mem);
         pthread_mutex_unlock(&lock);
     }
     else
@@ -104,9 +640,26 @@ void update_disk_io_gauge()
     unsigned long long reads, writes;
     get_disk_io_stats(&reads, &writes);
 
+    static struct disk_device_stats devices[MAX_DISK_DEVICES];
+    int device_count = get_disk_device_stats(devices, MAX_DISK_DEVICES);
+
     pthread_mutex_lock(&lock);
-    prom_gauge_set(disk_read_metric, reads, NULL);
-    prom_gauge_set(disk_write_metric, writes, NULL);
+    series_set(disk_read_metric, NULL, reads);
+    series_set(disk_write_metric, NULL, writes);
+
+    if (device_count >= 0)
+    {
+        series_sweep_begin(disk_device_read_metric);
+        series_sweep_begin(disk_device_write_metric);
+        for (int i = 0; i < device_count; i++)
+        {
+            const char* labels[] = {devices[i].name};
+            series_set(disk_device_read_metric, labels, devices[i].read_sectors);
+            series_set(disk_device_write_metric, labels, devices[i].write_sectors);
+        }
+        series_sweep_end(disk_device_read_metric);
+        series_sweep_end(disk_device_write_metric);
+    }
     pthread_mutex_unlock(&lock);
 }
 
@@ -115,9 +668,27 @@ void update_network_gauge()
     unsigned long long rx_bytes, tx_bytes;
     get_network_stats(&rx_bytes, &tx_bytes);
 
+    static struct net_interface_stats interfaces[MAX_INTERFACES];
+    int interface_count = get_network_interface_stats(interfaces, MAX_INTERFACES);
+
     pthread_mutex_lock(&lock);
-    prom_gauge_set(network_rx_metric, rx_bytes, NULL);
-    prom_gauge_set(network_tx_metric, tx_bytes, NULL);
+    series_set(network_rx_metric, NULL, rx_bytes);
+    series_set(network_tx_metric, NULL, tx_bytes);
+
+    // Las interfaces que ya no aparecen (p. ej. veths de contenedores terminados) quedan obsoletas
+    if (interface_count >= 0)
+    {
+        series_sweep_begin(network_interface_rx_metric);
+        series_sweep_begin(network_interface_tx_metric);
+        for (int i = 0; i < interface_count; i++)
+        {
+            const char* labels[] = {interfaces[i].name};
+            series_set(network_interface_rx_metric, labels, interfaces[i].rx_bytes);
+            series_set(network_interface_tx_metric, labels, interfaces[i].tx_bytes);
+        }
+        series_sweep_end(network_interface_rx_metric);
+        series_sweep_end(network_interface_tx_metric);
+    }
     pthread_mutex_unlock(&lock);
 }
 
@@ -127,7 +698,7 @@ void update_process_count_gauge()
     if (process_count >= 0)
     {
         pthread_mutex_lock(&lock);
-        prom_gauge_set(process_count_metric, process_count, NULL);
+        series_set(process_count_metric, NULL, process_count);
         pthread_mutex_unlock(&lock);
     }
     else
@@ -142,7 +713,7 @@ void update_context_switches_gauge()
     if (context_switches >= 0)
     {
         pthread_mutex_lock(&lock);
-        prom_gauge_set(context_switches_metric, context_switches, NULL);
+        series_set(context_switches_metric, NULL, context_switches);
         pthread_mutex_unlock(&lock);
     }
     else
@@ -151,8 +722,202 @@ void update_context_switches_gauge()
     }
 }
 
-int init_metrics()
+void update_numa_gauge()
+{
+    static struct numa_node_stats nodes[NUMA_MAX_NODES];
+    int node_count = numa_topology_refresh() >= 0 ? get_numa_node_stats(nodes, NUMA_MAX_NODES) : -1;
+    if (node_count < 0)
+    {
+        fprintf(stderr, "Error al obtener las estadísticas de los nodos NUMA\n");
+        return;
+    }
+
+    pthread_mutex_lock(&lock);
+    series_set(numa_topology_changes_metric, NULL, numa_topology_changes());
+
+    // Los nodos que se quitan (hotplug de memoria) quedan obsoletos
+    for (size_t m = 0; m < NUMA_METRIC_COUNT; m++)
+    {
+        series_sweep_begin(numa_metrics[m].family);
+    }
+    for (int i = 0; i < node_count; i++)
+    {
+        char node[LABEL_NUMBER_SIZE];
+        snprintf(node, sizeof(node), "%d", nodes[i].node);
+        const char* labels[] = {node};
+        for (size_t m = 0; m < NUMA_METRIC_COUNT; m++)
+        {
+            unsigned long long value = *(const unsigned long long*)((const char*)&nodes[i] + numa_metrics[m].offset);
+            series_set(numa_metrics[m].family, labels, value);
+        }
+    }
+    for (size_t m = 0; m < NUMA_METRIC_COUNT; m++)
+    {
+        series_sweep_end(numa_metrics[m].family);
+    }
+    pthread_mutex_unlock(&lock);
+}
+
+void update_tick_gauge(double duration, double jitter)
+{
+    static unsigned long long previous_evictions = 0;
+    struct series_stats stats;
+
+    pthread_mutex_lock(&lock);
+    series_set(tick_duration_metric, NULL, duration);
+    series_set(tick_jitter_metric, NULL, jitter);
+
+    series_get_stats(&stats);
+    series_set(series_active_metric, NULL, stats.active);
+    series_set(series_capacity_metric, NULL, stats.capacity);
+    series_set(series_evictions_metric, NULL, stats.evictions);
+    series_set(series_stale_metric, NULL, stats.staled);
+
+    // El ejemplar indica de qué familia fue la última serie desalojada y cuántas hubo en el ciclo
+    if (stats.evictions > previous_evictions && stats.last_evicted_family >= 0)
+    {
+        series_set_exemplar(series_evictions_metric, NULL, "family", series_family_name(stats.last_evicted_family),
+                            stats.evictions - previous_evictions);
+    }
+    previous_evictions = stats.evictions;
+    pthread_mutex_unlock(&lock);
+}
+
+void update_collector_gauge(const char* collector, double interval, unsigned long long runs)
+{
+    const char* labels[] = {collector};
+
+    pthread_mutex_lock(&lock);
+    series_set(collector_interval_metric, labels, interval);
+    series_set(collector_runs_metric, labels, runs);
+    pthread_mutex_unlock(&lock);
+}
+
+void update_rules_gauge()
+{
+    static struct rule_status status[CONFIG_MAX_RULES];
+    struct rule_action_stats actions;
+    size_t rule_count = rules_get_status(status, CONFIG_MAX_RULES);
+    rules_get_action_stats(&actions);
+
+    pthread_mutex_lock(&lock);
+
+    // Las reglas que se quitan de la configuración dejan de exponerse
+    series_sweep_begin(rule_state_metric);
+    series_sweep_begin(rule_value_metric);
+    series_sweep_begin(rule_firing_metric);
+    for (size_t i = 0; i < rule_count; i++)
+    {
+        const char* labels[] = {status[i].name};
+        series_set(rule_state_metric, labels, status[i].state);
+        series_set(rule_value_metric, labels, status[i].value);
+        series_set(rule_firing_metric, labels, status[i].fired);
+    }
+    series_sweep_end(rule_state_metric);
+    series_sweep_end(rule_value_metric);
+    series_sweep_end(rule_firing_metric);
+
+    series_set(rule_actions_metric, (const char*[]){"ok"}, actions.ok);
+    series_set(rule_actions_metric, (const char*[]){"failed"}, actions.failed);
+    series_set(rule_actions_metric, (const char*[]){"dropped"}, actions.dropped);
+    pthread_mutex_unlock(&lock);
+}
+
+/**
+ * @brief Publica un histograma de sockets en los gauges por estado y por bucket de cola.
+ *
+ * Los buckets se exponen acumulados, como en un histograma de Prometheus. Los sockets UDP se
+ * etiquetan como "connected" o "unconnected", no con los estados de TCP, y sólo TCP tiene
+ * sockets en LISTEN para el histograma de la cola de accept().
+ * Debe llamarse con el mutex tomado.
+ *
+ * @param state_metric Gauge etiquetado por estado.
+ * @param protocol Nombre del protocolo para la etiqueta de los buckets ("tcp" o "udp").
+ * @param hist Histograma obtenido con get_socket_histogram().
+ */
+static void set_socket_histogram(int state_metric, const char* protocol, const struct sock_histogram* hist)
+{
+    bool udp = strcmp(protocol, "udp") == 0;
+    for (int state = 1; state < SOCK_STATE_COUNT; state++)
+    {
+        const char* state_label[] = {udp ? sock_udp_state_name(state) : sock_state_name(state)};
+        if (state_label[0] != NULL)
+        {
+            series_set(state_metric, state_label, hist->by_state[state]);
+        }
+    }
+
+    unsigned long long recv_cumulative = 0, send_cumulative = 0, accept_cumulative = 0;
+    for (int bucket = 0; bucket < SOCK_QUEUE_BUCKETS; bucket++)
+    {
+        const char* bucket_labels[] = {protocol, queue_bucket_labels[bucket]};
+        recv_cumulative += hist->recv_queue[bucket];
+        send_cumulative += hist->send_queue[bucket];
+        series_set(socket_recv_queue_metric, bucket_labels, recv_cumulative);
+        series_set(socket_send_queue_metric, bucket_labels, send_cumulative);
+        if (!udp)
+        {
+            accept_cumulative += hist->accept_queue[bucket];
+            series_set(socket_accept_queue_metric, (const char*[]){queue_bucket_labels[bucket]}, accept_cumulative);
+        }
+    }
+}
+
+void update_socket_stats_gauge()
 {
+    struct net_proto_stats stats;
+    if (get_net_proto_stats(&stats) == 0)
+    {
+        pthread_mutex_lock(&lock);
+        for (size_t i = 0; i < PROTO_METRIC_COUNT; i++)
+        {
+            unsigned long long value = *(const unsigned long long*)((const char*)&stats + proto_metrics[i].offset);
+            series_set(proto_metrics[i].family, NULL, value);
+        }
+        pthread_mutex_unlock(&lock);
+    }
+    else
+    {
+        fprintf(stderr, "Error al obtener los contadores de protocolo\n");
+    }
+
+    // El volcado netlink se hace fuera del mutex: con muchos sockets puede tardar varios milisegundos
+    struct sock_histogram tcp_hist, udp_hist;
+    int tcp_ret = get_socket_histogram(IPPROTO_TCP, &tcp_hist);
+    int udp_ret = get_socket_histogram(IPPROTO_UDP, &udp_hist);
+
+    pthread_mutex_lock(&lock);
+    if (tcp_ret == 0)
+    {
+        set_socket_histogram(tcp_sockets_metric, "tcp", &tcp_hist);
+    }
+    if (udp_ret == 0)
+    {
+        set_socket_histogram(udp_sockets_metric, "udp", &udp_hist);
+    }
+    pthread_mutex_unlock(&lock);
+
+    if (tcp_ret != 0 || udp_ret != 0)
+    {
+        fprintf(stderr, "Error al obtener el histograma de sockets\n");
+    }
+}
+
+/**
+ * @brief Devuelve el momento del arranque del sistema en segundos desde la época.
+ */
+static double boot_time_seconds(void)
+{
+    struct timespec realtime, boottime;
+    clock_gettime(CLOCK_REALTIME, &realtime);
+    clock_gettime(CLOCK_BOOTTIME, &boottime);
+    return (realtime.tv_sec - boottime.tv_sec) + (realtime.tv_nsec - boottime.tv_nsec) / 1e9;
+}
+
+int init_metrics(size_t max_series)
+{
+    double boot_time = boot_time_seconds();
+
     // Inicializamos el mutex
     if (pthread_mutex_init(&lock, NULL) != 0)
     {
@@ -160,105 +925,261 @@ int init_metrics()
         return EXIT_FAILURE;
     }
 
-    // Inicializamos el registro de coleccionistas de Prometheus
-    if (prom_collector_registry_default_init() != 0)
+    for (int format = 0; format < EXPOSITION_FORMAT_COUNT; format++)
+    {
+        expositions[format].profile_section = self_profile_section(expositions[format].profile_name);
+    }
+
+    // Inicializamos la tabla de series con su capacidad máxima
+    if (series_table_init(max_series) != 0)
     {
-        fprintf(stderr, "Error al inicializar el registro de Prometheus\n");
+        fprintf(stderr, "Error al inicializar la tabla de series\n");
         return EXIT_FAILURE;
     }
 
     // Creamos la métrica para el uso de CPU
-    cpu_usage_metric = prom_gauge_new("cpu_usage_percentage", "Porcentaje de uso de CPU", 0, NULL);
-    if (cpu_usage_metric == NULL)
+    cpu_usage_metric =
+        series_family_new("cpu_usage_percentage", "Porcentaje de uso de CPU", SERIES_GAUGE, 0, NULL);
+    if (cpu_usage_metric < 0)
     {
         fprintf(stderr, "Error al crear la métrica de uso de CPU\n");
         return EXIT_FAILURE;
     }
 
     // Creamos la métrica para el uso de memoria
-    memory_usage_metric = prom_gauge_new("memory_usage_percentage", "Porcentaje de uso de memoria", 0, NULL);
-    if (memory_usage_metric == NULL)
+    memory_usage_metric =
+        series_family_new("memory_usage_percentage", "Porcentaje de uso de memoria", SERIES_GAUGE, 0, NULL);
+    if (memory_usage_metric < 0)
     {
         fprintf(stderr, "Error al crear la métrica de uso de memoria\n");
         return EXIT_FAILURE;
     }
 
     // Creamos las métricas adicionales
-    memory_total_metric = prom_gauge_new("memory_total", "Total Memory", 0, NULL);
-    if (memory_total_metric == NULL)
+    memory_total_metric = series_family_new("memory_total", "Total Memory", SERIES_GAUGE, 0, NULL);
+    if (memory_total_metric < 0)
     {
         fprintf(stderr, "Error al crear la métrica de memoria total\n");
         return EXIT_FAILURE;
     }
 
-    memory_used_metric = prom_gauge_new("memory_used", "Used Memory", 0, NULL);
-    if (memory_used_metric == NULL)
+    memory_used_metric = series_family_new("memory_used", "Used Memory", SERIES_GAUGE, 0, NULL);
+    if (memory_used_metric < 0)
     {
         fprintf(stderr, "Error al crear la métrica de memoria usada\n");
         return EXIT_FAILURE;
     }
 
-    memory_free_metric = prom_gauge_new("memory_free", "Free Memory", 0, NULL);
-    if (memory_free_metric == NULL)
+    memory_free_metric = series_family_new("memory_free", "Free Memory", SERIES_GAUGE, 0, NULL);
+    if (memory_free_metric < 0)
     {
         fprintf(stderr, "Error al crear la métrica de memoria libre\n");
         return EXIT_FAILURE;
     }
 
-    process_count_metric = prom_gauge_new("process_count", "Process Count", 0, NULL);
-    if (process_count_metric == NULL)
+    process_count_metric = series_family_new("process_count", "Process Count", SERIES_GAUGE, 0, NULL);
+    if (process_count_metric < 0)
     {
         fprintf(stderr, "Error al crear la métrica de conteo de procesos\n");
         return EXIT_FAILURE;
     }
 
-    context_switches_metric = prom_gauge_new("context_switches", "Context Switches", 0, NULL);
-    if (context_switches_metric == NULL)
+    context_switches_metric = series_family_new("context_switches", "Context Switches", SERIES_GAUGE, 0, NULL);
+    if (context_switches_metric < 0)
     {
         fprintf(stderr, "Error al crear la métrica de cambios de contexto\n");
         return EXIT_FAILURE;
     }
 
-    disk_read_metric = prom_gauge_new("disk_read", "Disk Read", 0, NULL);
-    if (disk_read_metric == NULL)
+    disk_read_metric = series_family_new("disk_read", "Disk Read", SERIES_GAUGE, 0, NULL);
+    if (disk_read_metric < 0)
     {
         fprintf(stderr, "Error al crear la métrica de lectura de disco\n");
         return EXIT_FAILURE;
     }
 
-    disk_write_metric = prom_gauge_new("disk_write", "Disk Write", 0, NULL);
-    if (disk_write_metric == NULL)
+    disk_write_metric = series_family_new("disk_write", "Disk Write", SERIES_GAUGE, 0, NULL);
+    if (disk_write_metric < 0)
     {
         fprintf(stderr, "Error al crear la métrica de escritura de disco\n");
         return EXIT_FAILURE;
     }
 
-    network_rx_metric = prom_gauge_new("network_rx", "Network RX", 0, NULL);
-    if (network_rx_metric == NULL)
+    network_rx_metric = series_family_new("network_rx", "Network RX", SERIES_GAUGE, 0, NULL);
+    if (network_rx_metric < 0)
     {
         fprintf(stderr, "Error al crear la métrica de recepción de red\n");
         return EXIT_FAILURE;
     }
 
-    network_tx_metric = prom_gauge_new("network_tx", "Network TX", 0, NULL);
-    if (network_tx_metric == NULL)
+    network_tx_metric = series_family_new("network_tx", "Network TX", SERIES_GAUGE, 0, NULL);
+    if (network_tx_metric < 0)
     {
         fprintf(stderr, "Error al crear la métrica de transmisión de red\n");
         return EXIT_FAILURE;
     }
 
-    // Registramos las métricas en el registro por defecto
-    prom_collector_registry_must_register_metric(cpu_usage_metric);
-    prom_collector_registry_must_register_metric(memory_usage_metric);
-    prom_collector_registry_must_register_metric(memory_total_metric);
-    prom_collector_registry_must_register_metric(memory_used_metric);
-    prom_collector_registry_must_register_metric(memory_free_metric);
-    prom_collector_registry_must_register_metric(process_count_metric);
-    prom_collector_registry_must_register_metric(context_switches_metric);
-    prom_collector_registry_must_register_metric(disk_read_metric);
-    prom_collector_registry_must_register_metric(disk_write_metric);
-    prom_collector_registry_must_register_metric(network_rx_metric);
-    prom_collector_registry_must_register_metric(network_tx_metric);
+    // Creamos las métricas de sockets
+    for (size_t i = 0; i < PROTO_METRIC_COUNT; i++)
+    {
+        proto_metrics[i].family =
+            series_family_new(proto_metrics[i].name, proto_metrics[i].help, proto_metrics[i].type, 0, NULL);
+        if (proto_metrics[i].family < 0)
+        {
+            fprintf(stderr, "Error al crear la métrica %s\n", proto_metrics[i].name);
+            return EXIT_FAILURE;
+        }
+        if (proto_metrics[i].type == SERIES_COUNTER)
+        {
+            series_family_set_created(proto_metrics[i].family, boot_time);
+        }
+    }
+
+    const char* state_keys[] = {"state"};
+    tcp_sockets_metric = series_family_new("tcp_sockets", "TCP Sockets By State", SERIES_GAUGE, 1, state_keys);
+    udp_sockets_metric = series_family_new("udp_sockets", "UDP Sockets By State", SERIES_GAUGE, 1, state_keys);
+    if (tcp_sockets_metric < 0 || udp_sockets_metric < 0)
+    {
+        fprintf(stderr, "Error al crear las métricas de sockets por estado\n");
+        return EXIT_FAILURE;
+    }
+
+    const char* bucket_keys[] = {"protocol", "le"};
+    socket_recv_queue_metric =
+        series_family_new("socket_recv_queue_bytes_bucket", "Sockets By Recv-Q Size (Cumulative)", SERIES_GAUGE, 2, bucket_keys);
+    socket_send_queue_metric =
+        series_family_new("socket_send_queue_bytes_bucket", "Sockets By Send-Q Size (Cumulative)", SERIES_GAUGE, 2, bucket_keys);
+    const char* accept_bucket_keys[] = {"le"};
+    socket_accept_queue_metric = series_family_new("tcp_listen_accept_queue_bucket",
+                                                   "TCP Listen Sockets By Accept Queue Length (Cumulative)",
+                                                   SERIES_GAUGE, 1, accept_bucket_keys);
+    if (socket_recv_queue_metric < 0 || socket_send_queue_metric < 0 || socket_accept_queue_metric < 0)
+    {
+        fprintf(stderr, "Error al crear las métricas de colas de sockets\n");
+        return EXIT_FAILURE;
+    }
+
+    for (int bucket = 0; bucket < SOCK_QUEUE_BUCKETS; bucket++)
+    {
+        long long bound = sock_queue_bucket_bound(bucket);
+        if (bound < 0)
+        {
+            snprintf(queue_bucket_labels[bucket], sizeof(queue_bucket_labels[bucket]), "+Inf");
+        }
+        else
+        {
+            snprintf(queue_bucket_labels[bucket], sizeof(queue_bucket_labels[bucket]), "%lld", bound);
+        }
+    }
+
+    const char* interface_keys[] = {"interface"};
+    network_interface_rx_metric =
+        series_family_new("network_interface_rx_bytes_total", "Network RX By Interface", SERIES_COUNTER, 1, interface_keys);
+    network_interface_tx_metric =
+        series_family_new("network_interface_tx_bytes_total", "Network TX By Interface", SERIES_COUNTER, 1, interface_keys);
+    const char* device_keys[] = {"device"};
+    disk_device_read_metric =
+        series_family_new("disk_device_read_sectors_total", "Disk Sectors Read By Device", SERIES_COUNTER, 1, device_keys);
+    disk_device_write_metric = series_family_new("disk_device_write_sectors_total", "Disk Sectors Written By Device",
+                                                 SERIES_COUNTER, 1, device_keys);
+    if (network_interface_rx_metric < 0 || network_interface_tx_metric < 0 || disk_device_read_metric < 0 ||
+        disk_device_write_metric < 0)
+    {
+        fprintf(stderr, "Error al crear las métricas por interfaz y por dispositivo\n");
+        return EXIT_FAILURE;
+    }
+
+    // Los contadores del kernel se acumulan desde el arranque, no desde que el agente los ve
+    series_family_set_created(network_interface_rx_metric, boot_time);
+    series_family_set_created(network_interface_tx_metric, boot_time);
+    series_family_set_created(disk_device_read_metric, boot_time);
+    series_family_set_created(disk_device_write_metric, boot_time);
+
+    const char* core_keys[] = {"cpu", "node", "socket"};
+    cpu_core_usage_metric = series_family_new("cpu_core_usage_percentage", "Porcentaje de uso de CPU por núcleo",
+                                              SERIES_GAUGE, 3, core_keys);
+    if (cpu_core_usage_metric < 0)
+    {
+        fprintf(stderr, "Error al crear la métrica de uso de CPU por núcleo\n");
+        return EXIT_FAILURE;
+    }
+
+    // Creamos las métricas de los nodos NUMA
+    const char* node_keys[] = {"node"};
+    for (size_t i = 0; i < NUMA_METRIC_COUNT; i++)
+    {
+        numa_metrics[i].family =
+            series_family_new(numa_metrics[i].name, numa_metrics[i].help, numa_metrics[i].type, 1, node_keys);
+        if (numa_metrics[i].family < 0)
+        {
+            fprintf(stderr, "Error al crear la métrica %s\n", numa_metrics[i].name);
+            return EXIT_FAILURE;
+        }
+        series_family_set_created(numa_metrics[i].family, boot_time);
+    }
+
+    numa_topology_changes_metric = series_family_new(
+        "numa_topology_changes_total", "CPU Or Memory Hotplug Events Detected", SERIES_COUNTER, 0, NULL);
+    if (numa_topology_changes_metric < 0)
+    {
+        fprintf(stderr, "Error al crear la métrica de cambios de topología\n");
+        return EXIT_FAILURE;
+    }
+
+    tick_duration_metric = series_family_new("collector_tick_duration_seconds", "Duration Of The Last Collection Tick",
+                                             SERIES_GAUGE, 0, NULL);
+    tick_jitter_metric = series_family_new("collector_tick_jitter_seconds",
+                                           "Delay Of The Last Tick Start Past Its Schedule", SERIES_GAUGE, 0, NULL);
+    if (tick_duration_metric < 0 || tick_jitter_metric < 0)
+    {
+        fprintf(stderr, "Error al crear las métricas del ciclo de recolección\n");
+        return EXIT_FAILURE;
+    }
+    series_family_set_self(tick_duration_metric);
+    series_family_set_self(tick_jitter_metric);
+
+    const char* rule_keys[] = {"rule"};
+    const char* result_keys[] = {"result"};
+    rule_state_metric = series_family_new("rule_state", "Alert Rule State (0 Inactive, 1 Pending, 2 Firing)",
+                                          SERIES_GAUGE, 1, rule_keys);
+    rule_value_metric = series_family_new("rule_value", "Last Value Or Rate Compared By The Alert Rule",
+                                          SERIES_GAUGE, 1, rule_keys);
+    rule_firing_metric =
+        series_family_new("rule_firing_total", "Times The Alert Rule Started Firing", SERIES_COUNTER, 1, rule_keys);
+    rule_actions_metric = series_family_new("rule_actions_total", "Alert Rule Actions By Result", SERIES_COUNTER, 1,
+                                            result_keys);
+    if (rule_state_metric < 0 || rule_value_metric < 0 || rule_firing_metric < 0 || rule_actions_metric < 0)
+    {
+        fprintf(stderr, "Error al crear las métricas de las reglas\n");
+        return EXIT_FAILURE;
+    }
+
+    const char* collector_keys[] = {"collector"};
+    collector_interval_metric = series_family_new("collector_interval_seconds",
+                                                  "Current Interval Between Runs Of Each Collector", SERIES_GAUGE,
+                                                  1, collector_keys);
+    collector_runs_metric = series_family_new("collector_runs_total", "Runs Of Each Collector", SERIES_COUNTER, 1,
+                                              collector_keys);
+    if (collector_interval_metric < 0 || collector_runs_metric < 0)
+    {
+        fprintf(stderr, "Error al crear las métricas de los colectores\n");
+        return EXIT_FAILURE;
+    }
+    series_family_set_self(collector_interval_metric);
+    series_family_set_self(collector_runs_metric);
+
+    series_active_metric = series_family_new("series_active", "Active Series", SERIES_GAUGE, 0, NULL);
+    series_capacity_metric = series_family_new("series_capacity", "Maximum Number Of Series", SERIES_GAUGE, 0, NULL);
+    series_evictions_metric = series_family_new(
+        "series_evictions_total", "Active Series Evicted Because The Table Was Full", SERIES_COUNTER, 0, NULL);
+    series_stale_metric = series_family_new("series_stale_total", "Series Marked Stale After Disappearing",
+                                            SERIES_COUNTER, 0, NULL);
+    if (series_active_metric < 0 || series_capacity_metric < 0 || series_evictions_metric < 0 ||
+        series_stale_metric < 0)
+    {
+        fprintf(stderr, "Error al crear las métricas de la tabla de series\n");
+        return EXIT_FAILURE;
+    }
 
     return EXIT_SUCCESS;
 }
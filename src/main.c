@@ -1,17 +1,23 @@
+#define _GNU_SOURCE // ppoll
+
+#include "../include/alloc_check.h"
+#include "../include/collectors.h"
+#include "../include/config.h"
 #include "../include/expose_metrics.h"
 #include "../include/metrics.h"
-#include <cjson/cJSON.h>
+#include "../include/proc_source.h"
+#include "../include/rules.h"
+#include "../include/self_profile.h"
+#include <errno.h>
+#include <poll.h>
 #include <pthread.h>
 #include <signal.h>
 #include <stdbool.h>
 #include <stdlib.h>
 #include <unistd.h>
 #include <stdio.h>
-
-/**
- * @brief Señal para recargar la configuración.
- */
-volatile sig_atomic_t reload_config = 0;
+#include <string.h>
+#include <time.h>
 
 /**
  * @brief Señal para detener el programa.
@@ -19,126 +25,74 @@ volatile sig_atomic_t reload_config = 0;
 volatile sig_atomic_t stop_program = 0;
 
 /**
- * @brief Variables booleanas para controlar qué métricas se deben mostrar.
- */
-
-/** @brief Indica si se debe mostrar la métrica de uso de CPU. */
-bool show_cpu_usage = false;
-
-/** @brief Indica si se debe mostrar la métrica de uso de memoria. */
-bool show_memory_usage = false;
-
-/** @brief Indica si se debe mostrar la métrica de I/O de disco. */
-bool show_disk_io = false;
-
-/** @brief Indica si se deben mostrar las estadísticas de red. */
-bool show_network_stats = false;
-
-/** @brief Indica si se debe mostrar el conteo de procesos. */
-bool show_process_count = false;
-
-/** @brief Indica si se deben mostrar los cambios de contexto. */
-bool show_context_switches = false;
-
-/**
- * @brief Intervalo de tiempo entre actualizaciones de métricas.
- */
-int interval = 5;
-
-/**
- * @brief Manejador de señales para recargar la configuración o detener el programa.
+ * @brief Manejador de señales para detener el programa.
+ *
+ * SIGUSR1 no llega aquí: está bloqueada y la atiende el hilo de recarga de configuración.
  *
  * @param signal Señal recibida.
  */
 void handle_signal(int signal)
 {
-    if (signal == SIGUSR1)
-    {
-        reload_config = 1;
-    }
-    else if (signal == SIGINT)
+    if (signal == SIGINT)
     {
         stop_program = 1;
     }
 }
 
 /**
- * @brief Lee la configuración desde un archivo JSON.
- *
- * @param config_filename Nombre del archivo de configuración.
+ * @brief Devuelve el tiempo monótono actual en segundos.
  */
-void read_config(const char* config_filename)
+static double monotonic_seconds(void)
 {
-    FILE* file = fopen(config_filename, "r");
-    if (file == NULL)
-    {
-        perror("Error al abrir el archivo de configuración, usando métricas por defecto");
-        // Usar métricas por defecto
-        show_cpu_usage = true;
-        show_memory_usage = true;
-        show_disk_io = true;
-        show_network_stats = true;
-        show_process_count = true;
-        show_context_switches = true;
-        interval = 5;
-        return;
-    }
-
-    fseek(file, 0, SEEK_END);
-    long length = ftell(file);
-    fseek(file, 0, SEEK_SET);
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
 
-    char* data = (char*)malloc(length + 1);
-    fread(data, 1, length, file);
-    fclose(file);
-    data[length] = '\0';
+/**
+ * @brief Espera hasta un instante absoluto del reloj monótono, o hasta que se publique otra configuración.
+ *
+ * SIGINT sólo se desbloquea durante la espera (ppoll la habilita de forma atómica), así que una
+ * señal recibida mientras se recolecta no se pierde: interrumpe la próxima espera.
+ *
+ * @param deadline Instante en segundos de monotonic_seconds().
+ * @param wait_mask Máscara de señales a usar durante la espera.
+ * @return 1 si se publicó una configuración nueva, o 0 si se llegó al instante o se pidió detener.
+ */
+static int wait_until(double deadline, const sigset_t* wait_mask)
+{
+    struct pollfd wake = {.fd = config_wake_fd(), .events = POLLIN};
 
-    cJSON* json = cJSON_Parse(data);
-    if (json == NULL)
+    while (!stop_program)
     {
-        perror("Error al parsear el archivo JSON, usando métricas por defecto");
-        free(data);
-        // Usar métricas por defecto
-        show_cpu_usage = true;
-        show_memory_usage = true;
-        show_disk_io = true;
-        show_network_stats = true;
-        show_process_count = true;
-        show_context_switches = true;
-        interval = 5;
-        return;
-    }
-
-    cJSON* metrics_json = cJSON_GetObjectItemCaseSensitive(json, "metrics");
-    cJSON* interval_json = cJSON_GetObjectItemCaseSensitive(json, "interval");
+        // El tiempo restante se recalcula desde el instante absoluto tras cada interrupción. Si ya
+        // venció (reproducción con --fast, o un ciclo que se pasó de su período) se llama igual a
+        // ppoll con espera nula: SIGINT sólo se desbloquea ahí, y sin esa llamada no se atendería
+        double remaining = deadline - monotonic_seconds();
+        bool expired = remaining <= 0;
+        if (expired)
+        {
+            remaining = 0;
+        }
 
-    if (!cJSON_IsObject(metrics_json) || !cJSON_IsNumber(interval_json))
-    {
-        perror("Formato de archivo JSON inválido, usando métricas por defecto");
-        cJSON_Delete(json);
-        free(data);
-        // Usar métricas por defecto
-        show_cpu_usage = true;
-        show_memory_usage = true;
-        show_disk_io = true;
-        show_network_stats = true;
-        show_process_count = true;
-        show_context_switches = true;
-        interval = 5;
-        return;
+        struct timespec timeout = {.tv_sec = (time_t)remaining,
+                                   .tv_nsec = (long)((remaining - (time_t)remaining) * 1e9)};
+        int ret = ppoll(&wake, 1, &timeout, wait_mask);
+        if (ret > 0)
+        {
+            return 1;
+        }
+        if (ret < 0 && errno != EINTR)
+        {
+            perror("Error al esperar el próximo ciclo");
+            return 0;
+        }
+        if (expired && ret == 0)
+        {
+            return 0;
+        }
     }
-
-    show_cpu_usage = cJSON_IsTrue(cJSON_GetObjectItemCaseSensitive(metrics_json, "cpu"));
-    show_memory_usage = cJSON_IsTrue(cJSON_GetObjectItemCaseSensitive(metrics_json, "memory"));
-    show_disk_io = cJSON_IsTrue(cJSON_GetObjectItemCaseSensitive(metrics_json, "disk_io"));
-    show_network_stats = cJSON_IsTrue(cJSON_GetObjectItemCaseSensitive(metrics_json, "network_stats"));
-    show_process_count = cJSON_IsTrue(cJSON_GetObjectItemCaseSensitive(metrics_json, "process_count"));
-    show_context_switches = cJSON_IsTrue(cJSON_GetObjectItemCaseSensitive(metrics_json, "context_switches"));
-
-    interval = interval_json->valueint;
-
-    cJSON_Delete(json);
-    free(data);
+    return 0;
 }
 
 /**
@@ -150,67 +104,224 @@ void read_config(const char* config_filename)
  */
 int main(int argc, char* argv[])
 {
-    signal(SIGUSR1, handle_signal);
+    // SIGINT y SIGUSR1 quedan bloqueadas en todos los hilos: SIGINT se recibe durante la espera
+    // del bucle principal y SIGUSR1 la lee el hilo de recarga con signalfd
     signal(SIGINT, handle_signal);
+    sigset_t blocked, wait_mask;
+    sigemptyset(&blocked);
+    sigaddset(&blocked, SIGINT);
+    sigaddset(&blocked, SIGUSR1);
+    pthread_sigmask(SIG_BLOCK, &blocked, &wait_mask);
+    sigaddset(&wait_mask, SIGUSR1);
+    sigdelset(&wait_mask, SIGINT);
 
     if (argc < 2) {
-        fprintf(stderr, "Uso: %s <ruta_al_archivo_config.json>\n", argv[0]);
+        fprintf(stderr,
+                "Uso: %s <ruta_al_archivo_config.json> [--port <puerto>] [--record <captura>] "
+                "[--replay <captura> [--fast] [--loop]]\n",
+                argv[0]);
         return EXIT_FAILURE;
     }
 
     const char* config_filename = argv[1];
+    const char* record_filename = NULL;
+    const char* replay_filename = NULL;
+    bool replay_fast = false;
+    bool replay_loop = false;
+    int http_port = HTTP_PORT;
+
+    for (int i = 2; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--port") == 0 && i + 1 < argc)
+        {
+            char* end;
+            long port = strtol(argv[++i], &end, 10);
+            if (*end != '\0' || port < 1 || port > 65535)
+            {
+                fprintf(stderr, "Puerto inválido: %s\n", argv[i]);
+                return EXIT_FAILURE;
+            }
+            http_port = (int)port;
+        }
+        else if (strcmp(argv[i], "--record") == 0 && i + 1 < argc)
+        {
+            record_filename = argv[++i];
+        }
+        else if (strcmp(argv[i], "--replay") == 0 && i + 1 < argc)
+        {
+            replay_filename = argv[++i];
+        }
+        else if (strcmp(argv[i], "--fast") == 0)
+        {
+            replay_fast = true;
+        }
+        else if (strcmp(argv[i], "--loop") == 0)
+        {
+            replay_loop = true;
+        }
+        else
+        {
+            fprintf(stderr, "Argumento desconocido: %s\n", argv[i]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    // Origen de los datos de /proc: en vivo, grabando o reproduciendo una captura
+    if (record_filename != NULL && replay_filename != NULL)
+    {
+        fprintf(stderr, "--record y --replay no pueden usarse juntos\n");
+        return EXIT_FAILURE;
+    }
+    if (record_filename != NULL && proc_source_record(record_filename) != 0)
+    {
+        return EXIT_FAILURE;
+    }
+    if (replay_filename != NULL && proc_source_replay(replay_filename, !replay_fast, replay_loop) != 0)
+    {
+        return EXIT_FAILURE;
+    }
 
     // Leer la configuración inicial
-    read_config(config_filename);
+    if (config_init(config_filename) != 0)
+    {
+        return EXIT_FAILURE;
+    }
+    const struct config* config = config_acquire();
+
+    // Las métricas deben existir antes de que el servidor HTTP atienda el primer scrape
+    if (init_metrics(config->max_series) != EXIT_SUCCESS)
+    {
+        return EXIT_FAILURE;
+    }
 
     // Creamos un hilo para exponer las métricas vía HTTP
     pthread_t tid;
-    if (pthread_create(&tid, NULL, expose_metrics, NULL) != 0)
+    if (pthread_create(&tid, NULL, expose_metrics, &http_port) != 0)
     {
         fprintf(stderr, "Error al crear el hilo del servidor HTTP\n");
         return EXIT_FAILURE;
     }
 
-    init_metrics();
+    // Recargar la configuración al modificar el archivo o al recibir SIGUSR1
+    if (config_watch() != 0)
+    {
+        return EXIT_FAILURE;
+    }
+
+    // Las acciones de las alertas se ejecutan en su propio hilo, sin demorar la recolección
+    if (rules_init() != 0)
+    {
+        return EXIT_FAILURE;
+    }
 
     // Bucle principal para actualizar las métricas según el intervalo especificado
+    // Instante absoluto en que debe comenzar el próximo ciclo, también usado para medir el jitter
+    double deadline = monotonic_seconds();
+    int rules_profile = self_profile_section("rules");
+    int tick_profile = self_profile_section("tick");
+#ifdef ALLOC_CHECK
+    unsigned long tick_count = 0;
+    unsigned long long max_scrape_bytes = 0, max_scrape_allocations = 0;
+    size_t exposition_len = 0;
+#endif
+
     while (!stop_program)
     {
-        if (reload_config)
+        double tick_start = monotonic_seconds();
+        double jitter = tick_start > deadline ? tick_start - deadline : 0.0;
+
+        // La configuración se toma una sola vez por ciclo: un ciclo nunca ve una recarga a medias
+        config = config_acquire();
+
+        // Fin de la captura en modo reproducción
+        if (proc_source_begin_tick() != 0)
         {
-            // Volver a leer la configuración
-            read_config(config_filename);
-            reload_config = 0;
+            break;
         }
 
-        if (show_cpu_usage)
+#ifdef ALLOC_CHECK
+        unsigned long long allocations = alloc_check_count();
+#endif
+
+        // Las reglas se evalúan con cada muestra que publican los colectores
+        rules_configure(config);
+        self_profile_set_enabled(config->profile);
+
+        // Con "adaptive", los colectores cuyas series no cambian se ejecutan cada vez menos seguido
+        int collectors_ran = collectors_run(config);
+
+        // Las reglas cuya serie dejó de recibir muestras se resuelven aunque no corra ningún colector
+        size_t rules_expired = rules_expire(config);
+
+        // Un ciclo sin colectores no cambia las series observadas: las ya generadas siguen siendo
+        // válidas y sólo se vuelve a generar la contabilidad del ciclo, que se expone siempre al día
+        struct self_profile_sample profile_start;
+        if (collectors_ran > 0 || rules_expired > 0)
         {
-            update_cpu_gauge();
+            self_profile_begin(&profile_start);
+            update_rules_gauge();
+            self_profile_end(rules_profile, &profile_start);
         }
-        if (show_memory_usage)
+
+        self_profile_begin(&profile_start);
+        update_tick_gauge(monotonic_seconds() - tick_start, jitter);
+        self_profile_end(tick_profile, &profile_start);
+
+#ifdef ALLOC_CHECK
+        // Tras los primeros ciclos, la recolección no debe reservar memoria, y un scrape real sólo la
+        // respuesta de MHD: la exposición se genera en buffers que se conservan y no se copia
+        allocations = alloc_check_count() - allocations;
+        unsigned long long scrape_allocations, scrape_bytes;
+        if (alloc_check_scrape(http_port, &scrape_allocations, &scrape_bytes, &exposition_len) != 0)
         {
-            update_memory_gauge();
-            update_memory_gauge2();
+            return EXIT_FAILURE;
         }
-        if (show_disk_io)
+        tick_count++;
+        if (tick_count > ALLOC_CHECK_WARMUP_TICKS && allocations != 0)
         {
-            update_disk_io_gauge();
+            fprintf(stderr, "El ciclo %lu reservó memoria %llu veces\n", tick_count, allocations);
+            return EXIT_FAILURE;
         }
-        if (show_network_stats)
+        if (tick_count > ALLOC_CHECK_WARMUP_TICKS && scrape_bytes > ALLOC_CHECK_SCRAPE_MAX_BYTES)
         {
-            update_network_gauge();
+            fprintf(stderr, "El scrape del ciclo %lu reservó %llu bytes en %llu reservas (exposición de %zu bytes)\n",
+                    tick_count, scrape_bytes, scrape_allocations, exposition_len);
+            return EXIT_FAILURE;
         }
-        if (show_process_count)
+        if (tick_count > ALLOC_CHECK_WARMUP_TICKS && scrape_bytes > max_scrape_bytes)
         {
-            update_process_count_gauge();
+            max_scrape_bytes = scrape_bytes;
+            max_scrape_allocations = scrape_allocations;
         }
-        if (show_context_switches)
+#endif
+
+        // Los plazos son absolutos para que la duración de los ciclos no se acumule; si el ciclo se
+        // atrasó más de un intervalo, se retoma desde ahora en lugar de encadenar ciclos seguidos
+        deadline += proc_source_period(config->interval);
+        double now = monotonic_seconds();
+        if (deadline < now)
         {
-            update_context_switches_gauge();
+            deadline = now;
         }
 
-        sleep(interval);
+        // Una configuración nueva adelanta el próximo ciclo, que la aplica en milisegundos
+        if (wait_until(deadline, &wait_mask) == 1)
+        {
+            deadline = monotonic_seconds();
+        }
     }
 
+    proc_source_close();
+#ifdef ALLOC_CHECK
+    if (tick_count <= ALLOC_CHECK_WARMUP_TICKS)
+    {
+        fprintf(stderr, "No hubo ciclos suficientes para verificar las reservas de memoria\n");
+        return EXIT_FAILURE;
+    }
+    printf("%lu ciclos sin reservas de memoria después de los primeros %d\n", tick_count - ALLOC_CHECK_WARMUP_TICKS,
+           ALLOC_CHECK_WARMUP_TICKS);
+    printf("Scrapes: a lo sumo %llu reservas y %llu bytes (respuesta de MHD) por una exposición de %zu bytes\n",
+           max_scrape_allocations, max_scrape_bytes, exposition_len);
+#endif
     return EXIT_SUCCESS;
 }
@@ -1,28 +1,39 @@
 #include "../include/metrics.h"
+#include "../include/proc_source.h"
+#include <stddef.h>
 
 #define MEMINFO_PATH "/proc/meminfo"
 #define STAT_PATH "/proc/stat"
 #define DISKSTATS_PATH "/proc/diskstats"
 #define NETDEV_PATH "/proc/net/dev"
+#define SNMP_PATH "/proc/net/snmp"
+#define NETSTAT_PATH "/proc/net/netstat"
 #define BUFFER_SIZE 256
 #define CPU_FIELDS 8
 
+/**
+ * Buffer de lectura compartido por los colectores, que se ejecutan uno tras otro en el hilo principal.
+ * Crece hasta el tamaño del mayor archivo leído y se conserva entre ciclos, así que en régimen estable
+ * los colectores no reservan memoria; al leer archivos completos, las líneas largas (como TcpExt en
+ * /proc/net/netstat) tampoco se truncan.
+ */
+static struct proc_buffer scratch;
+
 double get_memory_usage()
 {
-    FILE* fp;
-    char buffer[BUFFER_SIZE];
+    char* buffer;
+    size_t offset = 0;
     unsigned long long total_mem = 0, free_mem = 0;
 
-    // Abrir el archivo /proc/meminfo
-    fp = fopen(MEMINFO_PATH, "r");
-    if (fp == NULL)
+    // Leer el archivo /proc/meminfo
+    if (proc_read(MEMINFO_PATH, &scratch) != 0)
     {
         perror("Error al abrir " MEMINFO_PATH);
         return -1.0;
     }
 
     // Leer los valores de memoria total y disponible
-    while (fgets(buffer, sizeof(buffer), fp) != NULL)
+    while ((buffer = proc_buffer_next_line(&scratch, &offset)) != NULL)
     {
         if (sscanf(buffer, "MemTotal: %llu kB", &total_mem) == 1)
         {
@@ -34,8 +45,6 @@ double get_memory_usage()
         }
     }
 
-    fclose(fp);
-
     // Verificar si se encontraron ambos valores
     if (total_mem == 0 || free_mem == 0)
     {
@@ -50,7 +59,7 @@ double get_memory_usage()
     return mem_usage_percent;
 }
 
-double get_cpu_usage()
+double get_cpu_usage(struct cpu_core_usage* cores, int max_cores, int* core_count)
 {
     static unsigned long long prev_user = 0, prev_nice = 0, prev_system = 0, prev_idle = 0, prev_iowait = 0,
                               prev_irq = 0, prev_softirq = 0, prev_steal = 0;
@@ -58,22 +67,20 @@ double get_cpu_usage()
     unsigned long long totald, idled;
     double cpu_usage_percent;
 
-    // Abrir el archivo /proc/stat
-    FILE* fp = fopen(STAT_PATH, "r");
-    if (fp == NULL)
+    // Leer el archivo /proc/stat; la primera línea tiene los tiempos agregados de todas las CPUs
+    if (proc_read(STAT_PATH, &scratch) != 0)
     {
         perror("Error al abrir " STAT_PATH);
         return -1.0;
     }
 
-    char buffer[BUFFER_SIZE * 4];
-    if (fgets(buffer, sizeof(buffer), fp) == NULL)
+    size_t offset = 0;
+    char* buffer = proc_buffer_next_line(&scratch, &offset);
+    if (buffer == NULL)
     {
-        perror("Error al leer " STAT_PATH);
-        fclose(fp);
+        fprintf(stderr, "Error al leer " STAT_PATH "\n");
         return -1.0;
     }
-    fclose(fp);
 
     // Analizar los valores de tiempo de CPU
     int ret = sscanf(buffer, "cpu  %llu %llu %llu %llu %llu %llu %llu %llu", &user, &nice, &system, &idle, &iowait,
@@ -84,6 +91,12 @@ double get_cpu_usage()
         return -1.0;
     }
 
+    // Las líneas "cpuN" siguen a la agregada en la misma lectura
+    if (cores != NULL)
+    {
+        *core_count = get_cpu_core_usage(&scratch, &offset, cores, max_cores);
+    }
+
     // Calcular las diferencias entre las lecturas actuales y anteriores
     unsigned long long prev_idle_total = prev_idle + prev_iowait;
     unsigned long long idle_total = idle + iowait;
@@ -121,26 +134,23 @@ double get_cpu_usage()
 
 void get_memory_usage2(double* total_mem, double* used_mem, double* free_mem)
 {
-    FILE* fp;
-    char buffer[BUFFER_SIZE];
+    char* buffer;
+    size_t offset = 0;
     unsigned long long mem_total = 0, mem_free = 0, mem_available = 0;
 
-    fp = fopen(MEMINFO_PATH, "r");
-    if (fp == NULL)
+    if (proc_read(MEMINFO_PATH, &scratch) != 0)
     {
         perror("Error al abrir " MEMINFO_PATH);
         return;
     }
 
-    while (fgets(buffer, sizeof(buffer), fp) != NULL)
+    while ((buffer = proc_buffer_next_line(&scratch, &offset)) != NULL)
     {
         sscanf(buffer, "MemTotal: %llu kB", &mem_total);
         sscanf(buffer, "MemFree: %llu kB", &mem_free);
         sscanf(buffer, "MemAvailable: %llu kB", &mem_available);
     }
 
-    fclose(fp);
-
     *total_mem = (double)mem_total / 1024.0;
     *free_mem = (double)mem_free / 1024.0;
     *used_mem = *total_mem - *free_mem;
@@ -148,56 +158,52 @@ void get_memory_usage2(double* total_mem, double* used_mem, double* free_mem)
 
 void get_disk_io_stats(unsigned long long* reads, unsigned long long* writes)
 {
-    FILE* fp;
-    char buffer[BUFFER_SIZE];
+    char* buffer;
+    size_t offset = 0;
     *reads = 0;
     *writes = 0;
 
-    fp = fopen(DISKSTATS_PATH, "r");
-    if (fp == NULL)
+    if (proc_read(DISKSTATS_PATH, &scratch) != 0)
     {
         perror("Error al abrir " DISKSTATS_PATH);
         return;
     }
 
     // Leer las estadísticas de disco
-    while (fgets(buffer, sizeof(buffer), fp) != NULL)
+    while ((buffer = proc_buffer_next_line(&scratch, &offset)) != NULL)
     {
         unsigned int major, minor;
         char device[32];
         unsigned long long read_sectors, write_sectors;
 
         // Parsear la línea para obtener las estadísticas de disco
-        if (sscanf(buffer, "%u %u %s %*u %*u %llu %*u %*u %*u %llu", &major, &minor, device, &read_sectors,
+        if (sscanf(buffer, "%u %u %31s %*u %*u %llu %*u %*u %*u %llu", &major, &minor, device, &read_sectors,
                    &write_sectors) == 5)
         {
             *reads += read_sectors;
             *writes += write_sectors;
         }
     }
-
-    fclose(fp);
 }
 
 void get_network_stats(unsigned long long* rx_bytes, unsigned long long* tx_bytes)
 {
-    FILE* fp;
-    char buffer[BUFFER_SIZE];
+    char* buffer;
+    size_t offset = 0;
     *rx_bytes = 0;
     *tx_bytes = 0;
 
-    fp = fopen(NETDEV_PATH, "r");
-    if (fp == NULL)
+    if (proc_read(NETDEV_PATH, &scratch) != 0)
     {
         perror("Error al abrir " NETDEV_PATH);
         return;
     }
 
     // Saltar las dos primeras líneas de encabezado
-    fgets(buffer, sizeof(buffer), fp);
-    fgets(buffer, sizeof(buffer), fp);
+    proc_buffer_next_line(&scratch, &offset);
+    proc_buffer_next_line(&scratch, &offset);
 
-    while (fgets(buffer, sizeof(buffer), fp) != NULL)
+    while ((buffer = proc_buffer_next_line(&scratch, &offset)) != NULL)
     {
         char interface[BUFFER_SIZE];
         unsigned long long rx_packets, rx_errs, rx_drop, rx_fifo, rx_frame, rx_compressed, rx_multicast;
@@ -207,24 +213,83 @@ void get_network_stats(unsigned long long* rx_bytes, unsigned long long* tx_byte
                rx_bytes, &rx_packets, &rx_errs, &rx_drop, &rx_fifo, &rx_frame, &rx_compressed, &rx_multicast, tx_bytes,
                &tx_packets, &tx_errs, &tx_drop, &tx_fifo, &tx_colls, &tx_carrier, &tx_compressed);
     }
+}
+
+int get_network_interface_stats(struct net_interface_stats* interfaces, int max_interfaces)
+{
+    char* buffer;
+    size_t offset = 0;
+    int count = 0;
+
+    if (proc_read(NETDEV_PATH, &scratch) != 0)
+    {
+        perror("Error al abrir " NETDEV_PATH);
+        return -1;
+    }
+
+    // Saltar las dos primeras líneas de encabezado
+    proc_buffer_next_line(&scratch, &offset);
+    proc_buffer_next_line(&scratch, &offset);
+
+    while (count < max_interfaces && (buffer = proc_buffer_next_line(&scratch, &offset)) != NULL)
+    {
+        // Con contadores grandes el nombre queda pegado al primer valor ("eth0:123"), así que se corta en ':'
+        char* colon = strchr(buffer, ':');
+        if (colon == NULL)
+        {
+            continue;
+        }
+        *colon = '\0';
+
+        struct net_interface_stats* iface = &interfaces[count];
+        if (sscanf(buffer, "%31s", iface->name) == 1 &&
+            sscanf(colon + 1, "%llu %*u %*u %*u %*u %*u %*u %*u %llu", &iface->rx_bytes, &iface->tx_bytes) == 2)
+        {
+            count++;
+        }
+    }
+
+    return count;
+}
+
+int get_disk_device_stats(struct disk_device_stats* devices, int max_devices)
+{
+    char* buffer;
+    size_t offset = 0;
+    int count = 0;
+
+    if (proc_read(DISKSTATS_PATH, &scratch) != 0)
+    {
+        perror("Error al abrir " DISKSTATS_PATH);
+        return -1;
+    }
 
-    fclose(fp);
+    while (count < max_devices && (buffer = proc_buffer_next_line(&scratch, &offset)) != NULL)
+    {
+        struct disk_device_stats* device = &devices[count];
+        if (sscanf(buffer, "%*u %*u %31s %*u %*u %llu %*u %*u %*u %llu", device->name, &device->read_sectors,
+                   &device->write_sectors) == 3)
+        {
+            count++;
+        }
+    }
+
+    return count;
 }
 
 int get_process_count()
 {
-    FILE* fp;
-    char buffer[BUFFER_SIZE];
+    char* buffer;
+    size_t offset = 0;
     int process_count = 0;
 
-    fp = fopen(STAT_PATH, "r");
-    if (fp == NULL)
+    if (proc_read(STAT_PATH, &scratch) != 0)
     {
         perror("Error al abrir " STAT_PATH);
         return -1;
     }
 
-    while (fgets(buffer, sizeof(buffer), fp) != NULL)
+    while ((buffer = proc_buffer_next_line(&scratch, &offset)) != NULL)
     {
         if (sscanf(buffer, "procs_running %d", &process_count) == 1)
         {
@@ -232,24 +297,22 @@ int get_process_count()
         }
     }
 
-    fclose(fp);
     return process_count;
 }
 
 unsigned long long get_context_switches()
 {
-    FILE* fp;
-    char buffer[BUFFER_SIZE];
+    char* buffer;
+    size_t offset = 0;
     unsigned long long context_switches = 0;
 
-    fp = fopen(STAT_PATH, "r");
-    if (fp == NULL)
+    if (proc_read(STAT_PATH, &scratch) != 0)
     {
         perror("Error al abrir " STAT_PATH);
         return 0;
     }
 
-    while (fgets(buffer, sizeof(buffer), fp) != NULL)
+    while ((buffer = proc_buffer_next_line(&scratch, &offset)) != NULL)
     {
         if (sscanf(buffer, "ctxt %llu", &context_switches) == 1)
         {
@@ -257,6 +320,113 @@ unsigned long long get_context_switches()
         }
     }
 
-    fclose(fp);
     return context_switches;
 }
+
+/**
+ * @brief Asocia un campo de /proc/net/snmp o /proc/net/netstat con su lugar en struct net_proto_stats.
+ */
+struct proto_field
+{
+    const char* proto; /**< Prefijo de la línea, incluyendo los dos puntos (p. ej. "Tcp:"). */
+    const char* name;  /**< Nombre de la columna en la línea de encabezado. */
+    size_t offset;     /**< Desplazamiento del campo dentro de struct net_proto_stats. */
+};
+
+static const struct proto_field PROTO_FIELDS[] = {
+    {"Tcp:", "ActiveOpens", offsetof(struct net_proto_stats, tcp_active_opens)},
+    {"Tcp:", "PassiveOpens", offsetof(struct net_proto_stats, tcp_passive_opens)},
+    {"Tcp:", "AttemptFails", offsetof(struct net_proto_stats, tcp_attempt_fails)},
+    {"Tcp:", "EstabResets", offsetof(struct net_proto_stats, tcp_estab_resets)},
+    {"Tcp:", "CurrEstab", offsetof(struct net_proto_stats, tcp_curr_estab)},
+    {"Tcp:", "InSegs", offsetof(struct net_proto_stats, tcp_in_segs)},
+    {"Tcp:", "OutSegs", offsetof(struct net_proto_stats, tcp_out_segs)},
+    {"Tcp:", "RetransSegs", offsetof(struct net_proto_stats, tcp_retrans_segs)},
+    {"Tcp:", "InErrs", offsetof(struct net_proto_stats, tcp_in_errs)},
+    {"Tcp:", "OutRsts", offsetof(struct net_proto_stats, tcp_out_rsts)},
+    {"TcpExt:", "ListenOverflows", offsetof(struct net_proto_stats, tcp_listen_overflows)},
+    {"TcpExt:", "ListenDrops", offsetof(struct net_proto_stats, tcp_listen_drops)},
+    {"TcpExt:", "TCPTimeouts", offsetof(struct net_proto_stats, tcp_timeouts)},
+    {"TcpExt:", "TCPSynRetrans", offsetof(struct net_proto_stats, tcp_syn_retrans)},
+    {"Udp:", "InDatagrams", offsetof(struct net_proto_stats, udp_in_datagrams)},
+    {"Udp:", "OutDatagrams", offsetof(struct net_proto_stats, udp_out_datagrams)},
+    {"Udp:", "NoPorts", offsetof(struct net_proto_stats, udp_no_ports)},
+    {"Udp:", "InErrors", offsetof(struct net_proto_stats, udp_in_errors)},
+    {"Udp:", "RcvbufErrors", offsetof(struct net_proto_stats, udp_rcvbuf_errors)},
+    {"Udp:", "SndbufErrors", offsetof(struct net_proto_stats, udp_sndbuf_errors)},
+};
+
+#define PROTO_FIELD_COUNT (sizeof(PROTO_FIELDS) / sizeof(PROTO_FIELDS[0]))
+
+/**
+ * @brief Recorre los pares encabezado/valores de un archivo con formato /proc/net/snmp.
+ *
+ * @param path Ruta del archivo a leer.
+ * @param stats Estructura donde se guardan los campos reconocidos.
+ * @return 0 en caso de éxito, o -1 si no se pudo abrir el archivo.
+ */
+static int read_proto_counters(const char* path, struct net_proto_stats* stats)
+{
+    char* header;
+    char* values;
+    size_t offset = 0;
+
+    if (proc_read(path, &scratch) != 0)
+    {
+        perror("Error al abrir el archivo de contadores de protocolo");
+        return -1;
+    }
+
+    while ((header = proc_buffer_next_line(&scratch, &offset)) != NULL)
+    {
+        values = proc_buffer_next_line(&scratch, &offset);
+        if (values == NULL)
+        {
+            break;
+        }
+
+        // Ambas líneas deben comenzar con el mismo prefijo "Proto:"
+        size_t prefix_len = strcspn(header, " ");
+        if (header[prefix_len] != ' ' || strncmp(header, values, prefix_len) != 0)
+        {
+            fprintf(stderr, "Formato inesperado en %s\n", path);
+            break;
+        }
+        header[prefix_len] = '\0';
+
+        // Avanzar en paralelo por los nombres y los valores de cada columna
+        char* header_save;
+        char* values_save;
+        char* name = strtok_r(header + prefix_len + 1, " \n", &header_save);
+        char* value = strtok_r(values + prefix_len + 1, " \n", &values_save);
+        while (name != NULL && value != NULL)
+        {
+            for (size_t i = 0; i < PROTO_FIELD_COUNT; i++)
+            {
+                if (strcmp(PROTO_FIELDS[i].proto, header) == 0 && strcmp(PROTO_FIELDS[i].name, name) == 0)
+                {
+                    *(unsigned long long*)((char*)stats + PROTO_FIELDS[i].offset) = strtoull(value, NULL, 10);
+                    break;
+                }
+            }
+            name = strtok_r(NULL, " \n", &header_save);
+            value = strtok_r(NULL, " \n", &values_save);
+        }
+    }
+
+    return 0;
+}
+
+int get_net_proto_stats(struct net_proto_stats* stats)
+{
+    memset(stats, 0, sizeof(*stats));
+
+    if (read_proto_counters(SNMP_PATH, stats) != 0)
+    {
+        return -1;
+    }
+
+    // /proc/net/netstat puede no existir en kernels mínimos; los contadores TcpExt quedan en 0
+    read_proto_counters(NETSTAT_PATH, stats);
+    return 0;
+}
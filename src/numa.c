@@ -0,0 +1,423 @@
+#include "../include/numa.h"
+#include "../include/metrics.h"
+#include "../include/proc_source.h"
+#include <stdbool.h>
+#include <stddef.h>
+
+#define CPU_ONLINE_PATH "/sys/devices/system/cpu/online"
+#define NODE_ONLINE_PATH "/sys/devices/system/node/online"
+#define CPU_PACKAGE_PATH "/sys/devices/system/cpu/cpu%d/topology/physical_package_id"
+#define NODE_CPULIST_PATH "/sys/devices/system/node/node%d/cpulist"
+#define NODE_MEMINFO_PATH "/sys/devices/system/node/node%d/meminfo"
+#define NODE_NUMASTAT_PATH "/sys/devices/system/node/node%d/numastat"
+#define PATH_SIZE 128
+#define KEY_SIZE 64
+// Las listas de CPUs de máquinas grandes ("0-23,48-71,...") pueden superar BUFFER_SIZE
+#define MASK_SIZE (BUFFER_SIZE * 4)
+#define CPU_FIELDS 8
+
+/**
+ * @brief Campo de un archivo de sysfs guardado en struct numa_node_stats.
+ */
+struct node_field
+{
+    const char* key; /**< Nombre del campo en el archivo. */
+    size_t offset;   /**< Desplazamiento del valor en struct numa_node_stats. */
+};
+
+/** Campos de nodeN/meminfo, expresados en kB */
+static const struct node_field MEMINFO_FIELDS[] = {
+    {"MemTotal", offsetof(struct numa_node_stats, mem_total)},
+    {"MemFree", offsetof(struct numa_node_stats, mem_free)},
+    {"MemUsed", offsetof(struct numa_node_stats, mem_used)},
+    {"FilePages", offsetof(struct numa_node_stats, file_pages)},
+    {"AnonPages", offsetof(struct numa_node_stats, anon_pages)},
+};
+
+/** Campos de nodeN/numastat */
+static const struct node_field NUMASTAT_FIELDS[] = {
+    {"numa_hit", offsetof(struct numa_node_stats, numa_hit)},
+    {"numa_miss", offsetof(struct numa_node_stats, numa_miss)},
+    {"numa_foreign", offsetof(struct numa_node_stats, numa_foreign)},
+    {"interleave_hit", offsetof(struct numa_node_stats, interleave_hit)},
+    {"local_node", offsetof(struct numa_node_stats, local_node)},
+    {"other_node", offsetof(struct numa_node_stats, other_node)},
+};
+
+#define FIELD_COUNT(fields) (sizeof(fields) / sizeof(fields[0]))
+
+/** Topología en caché: nodo y socket de cada CPU (-1 si no está en línea) */
+static bool topology_known = false;
+static int cpu_node[NUMA_MAX_CPUS];
+static int cpu_socket[NUMA_MAX_CPUS];
+static bool node_online[NUMA_MAX_NODES];
+static unsigned long long topology_changes = 0;
+static double refreshed_tick = -1.0;
+
+/** Máscaras en línea con las que se descubrió la topología en caché */
+static char cpu_online_mask[MASK_SIZE];
+static char node_online_mask[MASK_SIZE];
+
+/**
+ * @brief Tiempos de una CPU en la lectura anterior de /proc/stat.
+ */
+struct core_sample
+{
+    unsigned long long idle;   /**< Tiempo ocioso (idle + iowait). */
+    unsigned long long total;  /**< Tiempo total. */
+    unsigned long long sample; /**< Número de lectura en que se tomó (0 si nunca). */
+};
+
+static struct core_sample prev_samples[NUMA_MAX_CPUS];
+static unsigned long long sample_count = 0;
+
+/** Buffer de lectura reutilizado entre ciclos por todas las lecturas de este módulo */
+static struct proc_buffer scratch;
+
+/**
+ * @brief Lee la primera línea de un archivo de sysfs, sin el salto de línea.
+ *
+ * @return 0 en caso de éxito, o -1 si el archivo no existe o está vacío.
+ */
+static int read_sysfs_line(const char* path, char* buffer, size_t size)
+{
+    if (proc_read(path, &scratch) != 0)
+    {
+        return -1;
+    }
+
+    size_t offset = 0;
+    const char* line = proc_buffer_next_line(&scratch, &offset);
+    snprintf(buffer, size, "%s", line != NULL ? line : "");
+    return 0;
+}
+
+/**
+ * @brief Marca en un arreglo los elementos de una lista de sysfs como "0-3,8,10-11".
+ *
+ * @param list Lista a interpretar; una lista vacía no marca nada.
+ * @param set Arreglo a completar; se pone en false antes de marcar.
+ * @param max Tamaño del arreglo; los elementos mayores se ignoran.
+ * @return 0 en caso de éxito, o -1 si la lista está mal formada.
+ */
+static int parse_list(const char* list, bool* set, int max)
+{
+    memset(set, 0, max * sizeof(*set));
+
+    const char* p = list;
+    while (*p != '\0')
+    {
+        char* end;
+        long first = strtol(p, &end, 10);
+        if (end == p || first < 0)
+        {
+            return -1;
+        }
+
+        long last = first;
+        p = end;
+        if (*p == '-')
+        {
+            last = strtol(p + 1, &end, 10);
+            if (end == p + 1 || last < first)
+            {
+                return -1;
+            }
+            p = end;
+        }
+
+        for (long i = first; i <= last && i < max; i++)
+        {
+            set[i] = true;
+        }
+
+        if (*p == ',')
+        {
+            p++;
+        }
+        else if (*p != '\0')
+        {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief Descubre la topología completa a partir de las máscaras en línea indicadas.
+ *
+ * @param cpu_mask Contenido de /sys/devices/system/cpu/online.
+ * @param node_mask Contenido de /sys/devices/system/node/online, o NULL si el kernel no expone nodos.
+ */
+static int discover_topology(const char* cpu_mask, const char* node_mask)
+{
+    static bool cpu_online[NUMA_MAX_CPUS];
+    static bool node_cpus[NUMA_MAX_CPUS];
+    char path[PATH_SIZE];
+    char line[MASK_SIZE];
+
+    if (parse_list(cpu_mask, cpu_online, NUMA_MAX_CPUS) != 0)
+    {
+        fprintf(stderr, "Lista de CPUs inválida en " CPU_ONLINE_PATH ": %s\n", cpu_mask);
+        return -1;
+    }
+    if (node_mask == NULL)
+    {
+        memset(node_online, 0, sizeof(node_online));
+    }
+    else if (parse_list(node_mask, node_online, NUMA_MAX_NODES) != 0)
+    {
+        fprintf(stderr, "Lista de nodos inválida en " NODE_ONLINE_PATH ": %s\n", node_mask);
+        return -1;
+    }
+
+    // Sin nodos expuestos (kernel sin CONFIG_NUMA) toda la máquina es el nodo 0
+    for (int cpu = 0; cpu < NUMA_MAX_CPUS; cpu++)
+    {
+        cpu_node[cpu] = -1;
+        cpu_socket[cpu] = -1;
+        if (!cpu_online[cpu])
+        {
+            continue;
+        }
+
+        cpu_node[cpu] = 0;
+        cpu_socket[cpu] = 0;
+        snprintf(path, sizeof(path), CPU_PACKAGE_PATH, cpu);
+        if (read_sysfs_line(path, line, sizeof(line)) == 0)
+        {
+            cpu_socket[cpu] = atoi(line);
+        }
+    }
+
+    for (int node = 0; node < NUMA_MAX_NODES; node++)
+    {
+        if (!node_online[node])
+        {
+            continue;
+        }
+
+        snprintf(path, sizeof(path), NODE_CPULIST_PATH, node);
+        if (read_sysfs_line(path, line, sizeof(line)) != 0 || parse_list(line, node_cpus, NUMA_MAX_CPUS) != 0)
+        {
+            fprintf(stderr, "Error al leer las CPUs del nodo %d\n", node);
+            continue;
+        }
+        for (int cpu = 0; cpu < NUMA_MAX_CPUS; cpu++)
+        {
+            if (node_cpus[cpu] && cpu_online[cpu])
+            {
+                cpu_node[cpu] = node;
+            }
+        }
+    }
+
+    return 0;
+}
+
+int numa_topology_refresh(void)
+{
+    char cpu_mask[MASK_SIZE];
+    char node_mask[MASK_SIZE];
+
+    // El colector de CPU y el de NUMA la llaman en el mismo ciclo: las máscaras se leen una vez
+    double tick = proc_source_tick_time();
+    if (topology_known && tick == refreshed_tick)
+    {
+        return 0;
+    }
+    refreshed_tick = tick;
+
+    if (read_sysfs_line(CPU_ONLINE_PATH, cpu_mask, sizeof(cpu_mask)) != 0)
+    {
+        perror("Error al abrir " CPU_ONLINE_PATH);
+        return -1;
+    }
+    bool has_nodes = read_sysfs_line(NODE_ONLINE_PATH, node_mask, sizeof(node_mask)) == 0;
+    if (!has_nodes)
+    {
+        node_mask[0] = '\0';
+    }
+
+    // Caso habitual: nada cambió y la topología en caché sigue siendo válida
+    if (topology_known && strcmp(cpu_mask, cpu_online_mask) == 0 && strcmp(node_mask, node_online_mask) == 0)
+    {
+        return 0;
+    }
+
+    if (discover_topology(cpu_mask, has_nodes ? node_mask : NULL) != 0)
+    {
+        return -1;
+    }
+
+    if (topology_known)
+    {
+        topology_changes++;
+    }
+    topology_known = true;
+    strcpy(cpu_online_mask, cpu_mask);
+    strcpy(node_online_mask, node_mask);
+    return 1;
+}
+
+unsigned long long numa_topology_changes(void)
+{
+    return topology_changes;
+}
+
+int numa_cpu_node(int cpu)
+{
+    if (!topology_known || cpu < 0 || cpu >= NUMA_MAX_CPUS)
+    {
+        return -1;
+    }
+    return cpu_node[cpu];
+}
+
+int numa_cpu_socket(int cpu)
+{
+    if (!topology_known || cpu < 0 || cpu >= NUMA_MAX_CPUS)
+    {
+        return -1;
+    }
+    return cpu_socket[cpu];
+}
+
+/**
+ * @brief Lee un archivo de un nodo y guarda los campos conocidos.
+ *
+ * @param path Ruta del archivo.
+ * @param format Formato de sscanf que extrae el nombre del campo y su valor.
+ * @param fields Campos a guardar.
+ * @param field_count Cantidad de campos.
+ * @param scale Factor por el que se multiplica cada valor.
+ * @param stats Estructura donde se guardan los valores.
+ */
+static int read_node_fields(const char* path, const char* format, const struct node_field* fields,
+                            size_t field_count, unsigned long long scale, struct numa_node_stats* stats)
+{
+    char* buffer;
+    size_t offset = 0;
+    char key[KEY_SIZE];
+    unsigned long long value;
+
+    if (proc_read(path, &scratch) != 0)
+    {
+        return -1;
+    }
+
+    while ((buffer = proc_buffer_next_line(&scratch, &offset)) != NULL)
+    {
+        if (sscanf(buffer, format, key, &value) != 2)
+        {
+            continue;
+        }
+        for (size_t i = 0; i < field_count; i++)
+        {
+            if (strcmp(key, fields[i].key) == 0)
+            {
+                *(unsigned long long*)((char*)stats + fields[i].offset) = value * scale;
+                break;
+            }
+        }
+    }
+
+    return 0;
+}
+
+int get_numa_node_stats(struct numa_node_stats* nodes, int max_nodes)
+{
+    char path[PATH_SIZE];
+    int count = 0;
+
+    if (!topology_known && numa_topology_refresh() < 0)
+    {
+        return -1;
+    }
+
+    for (int node = 0; node < NUMA_MAX_NODES && count < max_nodes; node++)
+    {
+        if (!node_online[node])
+        {
+            continue;
+        }
+
+        struct numa_node_stats* stats = &nodes[count];
+        memset(stats, 0, sizeof(*stats));
+        stats->node = node;
+
+        // Un nodo que se quitó después de leer la topología se omite hasta el próximo descubrimiento
+        snprintf(path, sizeof(path), NODE_MEMINFO_PATH, node);
+        if (read_node_fields(path, "Node %*d %63[^:]: %llu", MEMINFO_FIELDS, FIELD_COUNT(MEMINFO_FIELDS), 1024,
+                             stats) != 0)
+        {
+            continue;
+        }
+        snprintf(path, sizeof(path), NODE_NUMASTAT_PATH, node);
+        if (read_node_fields(path, "%63s %llu", NUMASTAT_FIELDS, FIELD_COUNT(NUMASTAT_FIELDS), 1, stats) != 0)
+        {
+            continue;
+        }
+        count++;
+    }
+
+    return count;
+}
+
+int get_cpu_core_usage(struct proc_buffer* stat, size_t* offset, struct cpu_core_usage* cores, int max_cores)
+{
+    char* buffer;
+    int count = 0;
+
+    if (numa_topology_refresh() < 0)
+    {
+        return -1;
+    }
+
+    sample_count++;
+
+    while ((buffer = proc_buffer_next_line(stat, offset)) != NULL)
+    {
+        if (strncmp(buffer, "cpu", 3) != 0 || buffer[3] < '0' || buffer[3] > '9')
+        {
+            continue;
+        }
+
+        int cpu;
+        unsigned long long user, nice, system, idle, iowait, irq, softirq, steal;
+        if (sscanf(buffer, "cpu%d %llu %llu %llu %llu %llu %llu %llu %llu", &cpu, &user, &nice, &system, &idle,
+                   &iowait, &irq, &softirq, &steal) != CPU_FIELDS + 1 ||
+            cpu < 0 || cpu >= NUMA_MAX_CPUS)
+        {
+            continue;
+        }
+
+        unsigned long long idle_total = idle + iowait;
+        unsigned long long total = idle_total + user + nice + system + irq + softirq + steal;
+        struct core_sample* prev = &prev_samples[cpu];
+
+        // Una CPU que no apareció en la lectura anterior (recién puesta en línea) no tiene intervalo
+        if (prev->sample != 0 && prev->sample == sample_count - 1 && total > prev->total &&
+            numa_cpu_node(cpu) >= 0 && count < max_cores)
+        {
+            unsigned long long totald = total - prev->total;
+            unsigned long long idled = idle_total >= prev->idle ? idle_total - prev->idle : 0;
+            if (idled > totald)
+            {
+                idled = totald;
+            }
+
+            cores[count].cpu = cpu;
+            cores[count].node = numa_cpu_node(cpu);
+            cores[count].socket = numa_cpu_socket(cpu);
+            cores[count].usage = ((double)(totald - idled) / totald) * 100.0;
+            count++;
+        }
+
+        prev->idle = idle_total;
+        prev->total = total;
+        prev->sample = sample_count;
+    }
+
+    return count;
+}
@@ -0,0 +1,478 @@
+#include "../include/proc_source.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <zlib.h>
+
+#define CAPTURE_HEADER "# monitor-capture 1\n"
+#define ENTRY_NAME_SIZE 128
+#define LINE_SIZE 256
+#define READ_CHUNK 4096
+#define NSEC_PER_SEC 1000000000LL
+
+/**
+ * @brief Bytes de un archivo leído durante un ciclo de recolección.
+ *
+ * Los buffers se conservan entre ciclos para no reservar memoria en cada lectura.
+ */
+struct capture_entry
+{
+    char name[ENTRY_NAME_SIZE];  /**< Ruta del archivo o nombre de la entrada. */
+    struct proc_buffer content; /**< Contenido. */
+};
+
+static enum proc_source_mode mode = PROC_SOURCE_LIVE;
+static gzFile capture = NULL;
+
+/** Entradas del ciclo actual; sólo las primeras entry_count son válidas */
+static struct capture_entry* entries = NULL;
+static size_t entry_count = 0;
+static size_t entry_capacity = 0;
+
+/** Marca de tiempo del ciclo actual y del siguiente (-1 si la captura terminó) */
+static long long tick_timestamp = -1;
+static long long next_tick_timestamp = -1;
+static bool tick_open = false;
+
+static bool replay_realtime = true;
+static bool replay_loop = false;
+
+/**
+ * @brief Devuelve la hora actual en nanosegundos.
+ */
+static long long now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return ts.tv_sec * NSEC_PER_SEC + ts.tv_nsec;
+}
+
+/**
+ * @brief Busca una entrada del ciclo actual por nombre.
+ */
+static struct capture_entry* find_entry(const char* name)
+{
+    for (size_t i = 0; i < entry_count; i++)
+    {
+        if (strcmp(entries[i].name, name) == 0)
+        {
+            return &entries[i];
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief Agrega una entrada vacía al ciclo actual, reutilizando el buffer de ciclos anteriores.
+ */
+static struct capture_entry* add_entry(const char* name)
+{
+    if (strlen(name) >= ENTRY_NAME_SIZE)
+    {
+        fprintf(stderr, "Nombre de entrada demasiado largo: %s\n", name);
+        return NULL;
+    }
+
+    if (entry_count == entry_capacity)
+    {
+        size_t new_capacity = entry_capacity == 0 ? 16 : entry_capacity * 2;
+        struct capture_entry* new_entries = realloc(entries, new_capacity * sizeof(*entries));
+        if (new_entries == NULL)
+        {
+            perror("Error al reservar memoria para la captura");
+            return NULL;
+        }
+        memset(new_entries + entry_capacity, 0, (new_capacity - entry_capacity) * sizeof(*entries));
+        entries = new_entries;
+        entry_capacity = new_capacity;
+    }
+
+    struct capture_entry* entry = &entries[entry_count++];
+    strcpy(entry->name, name);
+    entry->content.len = 0;
+    return entry;
+}
+
+/**
+ * @brief Asegura que un buffer tenga lugar para al menos size bytes.
+ */
+static int reserve_buffer(struct proc_buffer* buffer, size_t size)
+{
+    if (size <= buffer->capacity)
+    {
+        return 0;
+    }
+
+    size_t new_capacity = buffer->capacity == 0 ? READ_CHUNK : buffer->capacity;
+    while (new_capacity < size)
+    {
+        new_capacity *= 2;
+    }
+
+    char* new_data = realloc(buffer->data, new_capacity);
+    if (new_data == NULL)
+    {
+        perror("Error al reservar memoria para la lectura");
+        return -1;
+    }
+    buffer->data = new_data;
+    buffer->capacity = new_capacity;
+    return 0;
+}
+
+/**
+ * @brief Lee un archivo completo en un buffer, dejando lugar para el terminador.
+ *
+ * Los archivos de /proc informan tamaño 0, así que se lee por bloques hasta EOF. El buffer sólo
+ * crece cuando el archivo no entra, de modo que en régimen estable la lectura no reserva memoria.
+ */
+static int read_file_into(struct proc_buffer* buffer, const char* path)
+{
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+    {
+        return -1;
+    }
+
+    buffer->len = 0;
+    while (1)
+    {
+        // Siempre queda al menos un byte libre para el terminador
+        if (buffer->capacity - buffer->len < 2 && reserve_buffer(buffer, buffer->len + READ_CHUNK) != 0)
+        {
+            close(fd);
+            return -1;
+        }
+
+        ssize_t n = read(fd, buffer->data + buffer->len, buffer->capacity - buffer->len - 1);
+        if (n < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            int saved_errno = errno;
+            close(fd);
+            errno = saved_errno;
+            return -1;
+        }
+        if (n == 0)
+        {
+            break;
+        }
+        buffer->len += n;
+    }
+
+    close(fd);
+    buffer->data[buffer->len] = '\0';
+    return 0;
+}
+
+/**
+ * @brief Escribe el ciclo grabado en la captura.
+ */
+static void flush_tick(void)
+{
+    if (!tick_open)
+    {
+        return;
+    }
+
+    gzprintf(capture, "T %lld\n", tick_timestamp);
+    for (size_t i = 0; i < entry_count; i++)
+    {
+        gzprintf(capture, "F %s %zu\n", entries[i].name, entries[i].content.len);
+        if (entries[i].content.len > 0)
+        {
+            gzwrite(capture, entries[i].content.data, entries[i].content.len);
+        }
+        gzputc(capture, '\n');
+    }
+    tick_open = false;
+}
+
+/**
+ * @brief Lee el encabezado de la captura y la marca de tiempo del primer ciclo.
+ */
+static int read_capture_header(void)
+{
+    char line[LINE_SIZE];
+
+    if (gzgets(capture, line, sizeof(line)) == NULL || strcmp(line, CAPTURE_HEADER) != 0)
+    {
+        fprintf(stderr, "El archivo no es una captura válida\n");
+        return -1;
+    }
+
+    next_tick_timestamp = -1;
+    if (gzgets(capture, line, sizeof(line)) != NULL && sscanf(line, "T %lld", &next_tick_timestamp) != 1)
+    {
+        fprintf(stderr, "Formato de captura inválido: %s", line);
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * @brief Carga en la tabla de entradas el siguiente ciclo de la captura.
+ */
+static int load_tick(void)
+{
+    char line[LINE_SIZE];
+
+    tick_timestamp = next_tick_timestamp;
+    next_tick_timestamp = -1;
+    entry_count = 0;
+
+    while (gzgets(capture, line, sizeof(line)) != NULL)
+    {
+        char name[ENTRY_NAME_SIZE];
+        size_t len;
+
+        if (sscanf(line, "T %lld", &next_tick_timestamp) == 1)
+        {
+            return 0;
+        }
+        if (sscanf(line, "F %127s %zu", name, &len) != 2)
+        {
+            fprintf(stderr, "Formato de captura inválido: %s", line);
+            return -1;
+        }
+
+        struct capture_entry* entry = add_entry(name);
+        if (entry == NULL || reserve_buffer(&entry->content, len + 1) != 0)
+        {
+            return -1;
+        }
+        if (len > 0 && gzread(capture, entry->content.data, len) != (int)len)
+        {
+            fprintf(stderr, "Captura truncada en %s\n", name);
+            return -1;
+        }
+        entry->content.len = len;
+        gzgetc(capture); // Salto de línea que separa las entradas
+    }
+
+    return 0;
+}
+
+int proc_source_record(const char* capture_path)
+{
+    capture = gzopen(capture_path, "wb");
+    if (capture == NULL)
+    {
+        perror("Error al crear el archivo de captura");
+        return -1;
+    }
+
+    gzputs(capture, CAPTURE_HEADER);
+    mode = PROC_SOURCE_RECORD;
+    return 0;
+}
+
+int proc_source_replay(const char* capture_path, bool realtime, bool loop)
+{
+    capture = gzopen(capture_path, "rb");
+    if (capture == NULL)
+    {
+        perror("Error al abrir el archivo de captura");
+        return -1;
+    }
+
+    if (read_capture_header() != 0)
+    {
+        gzclose(capture);
+        capture = NULL;
+        return -1;
+    }
+
+    replay_realtime = realtime;
+    replay_loop = loop;
+    mode = PROC_SOURCE_REPLAY;
+    return 0;
+}
+
+enum proc_source_mode proc_source_mode(void)
+{
+    return mode;
+}
+
+int proc_source_begin_tick(void)
+{
+    if (mode == PROC_SOURCE_RECORD)
+    {
+        flush_tick();
+        entry_count = 0;
+        tick_timestamp = now_ns();
+        tick_open = true;
+    }
+    else if (mode == PROC_SOURCE_REPLAY)
+    {
+        if (next_tick_timestamp < 0)
+        {
+            if (!replay_loop || gzrewind(capture) != 0 || read_capture_header() != 0 || next_tick_timestamp < 0)
+            {
+                return -1;
+            }
+        }
+        return load_tick();
+    }
+    else
+    {
+        tick_timestamp = now_ns();
+    }
+
+    return 0;
+}
+
+double proc_source_tick_time(void)
+{
+    return (double)tick_timestamp / NSEC_PER_SEC;
+}
+
+double proc_source_period(int interval)
+{
+    if (mode != PROC_SOURCE_REPLAY)
+    {
+        return interval;
+    }
+
+    if (!replay_realtime)
+    {
+        return 0.0;
+    }
+
+    // Al final de la captura (o al volver a empezar) se usa el intervalo configurado
+    if (next_tick_timestamp > tick_timestamp)
+    {
+        return (double)(next_tick_timestamp - tick_timestamp) / NSEC_PER_SEC;
+    }
+    return interval;
+}
+
+int proc_read(const char* path, struct proc_buffer* buffer)
+{
+    if (mode == PROC_SOURCE_LIVE)
+    {
+        return read_file_into(buffer, path);
+    }
+
+    struct capture_entry* entry = find_entry(path);
+    if (entry == NULL)
+    {
+        if (mode == PROC_SOURCE_REPLAY)
+        {
+            errno = ENOENT;
+            return -1;
+        }
+
+        entry = add_entry(path);
+        if (entry == NULL)
+        {
+            errno = ENOMEM;
+            return -1;
+        }
+        if (read_file_into(&entry->content, path) != 0)
+        {
+            // No se graba un archivo que no se pudo leer
+            int saved_errno = errno;
+            entry_count--;
+            errno = saved_errno;
+            return -1;
+        }
+    }
+
+    // Se copia porque quien lee modifica el buffer al separar las líneas
+    if (reserve_buffer(buffer, entry->content.len + 1) != 0)
+    {
+        errno = ENOMEM;
+        return -1;
+    }
+    if (entry->content.len > 0)
+    {
+        memcpy(buffer->data, entry->content.data, entry->content.len);
+    }
+    buffer->len = entry->content.len;
+    buffer->data[buffer->len] = '\0';
+    return 0;
+}
+
+char* proc_buffer_next_line(struct proc_buffer* buffer, size_t* offset)
+{
+    if (*offset >= buffer->len)
+    {
+        return NULL;
+    }
+
+    char* line = buffer->data + *offset;
+    char* newline = memchr(line, '\n', buffer->len - *offset);
+    if (newline == NULL)
+    {
+        // Última línea sin salto: ya está terminada por proc_read()
+        *offset = buffer->len;
+    }
+    else
+    {
+        *newline = '\0';
+        *offset = newline - buffer->data + 1;
+    }
+    return line;
+}
+
+void proc_source_append(const char* name, const void* data, size_t len)
+{
+    if (mode != PROC_SOURCE_RECORD)
+    {
+        return;
+    }
+
+    struct capture_entry* entry = find_entry(name);
+    if (entry == NULL)
+    {
+        entry = add_entry(name);
+    }
+    if (entry == NULL || reserve_buffer(&entry->content, entry->content.len + len) != 0)
+    {
+        return;
+    }
+
+    memcpy(entry->content.data + entry->content.len, data, len);
+    entry->content.len += len;
+}
+
+const char* proc_source_lookup(const char* name, size_t* len)
+{
+    if (mode != PROC_SOURCE_REPLAY)
+    {
+        return NULL;
+    }
+
+    struct capture_entry* entry = find_entry(name);
+    if (entry == NULL)
+    {
+        return NULL;
+    }
+
+    *len = entry->content.len;
+    return entry->content.data;
+}
+
+void proc_source_close(void)
+{
+    if (capture == NULL)
+    {
+        return;
+    }
+
+    if (mode == PROC_SOURCE_RECORD)
+    {
+        flush_tick();
+    }
+    gzclose(capture);
+    capture = NULL;
+    mode = PROC_SOURCE_LIVE;
+}
@@ -0,0 +1,706 @@
+#include "../include/rules.h"
+#include "../include/proc_source.h"
+#include "../include/series.h"
+#include <math.h>
+#include <netdb.h>
+#include <pthread.h>
+#include <signal.h>
+#include <spawn.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+#define WEBHOOK_HOST_SIZE 256
+#define WEBHOOK_PORT_SIZE 8
+#define WEBHOOK_REQUEST_SIZE 2048
+#define WEBHOOK_BODY_SIZE 1024
+#define WEBHOOK_RESPONSE_SIZE 64
+#define VALUE_TEXT_SIZE 32
+#define EXEC_POLL_NSEC 10000000L
+
+extern char** environ;
+
+/**
+ * @brief Muestra guardada en la ventana de una tasa.
+ */
+struct rule_sample
+{
+    double time;  /**< Momento del ciclo (segundos desde la época). */
+    double value; /**< Valor de la serie. */
+};
+
+/**
+ * @brief Regla activa: copia de su configuración, serie observada y estado de la evaluación.
+ *
+ * La configuración se copia porque el lugar de la configuración original se reutiliza en cuanto
+ * el planificador toma otra.
+ */
+struct rule
+{
+    struct rule_config config;                    /**< Configuración de la regla. */
+    int family;                                   /**< Familia observada. */
+    unsigned char match[SERIES_MAX_LABELS];       /**< Índice en config.label_values de cada etiqueta de la familia. */
+    enum rule_state state;                        /**< Estado actual. */
+    double since;                                 /**< Momento en que la comparación empezó a cumplirse. */
+    double value;                                 /**< Último valor comparado. */
+    double last_time;                             /**< Momento de la última muestra (0 = ninguna). */
+    unsigned long long fired;                     /**< Veces que pasó a "firing". */
+    struct rule_sample samples[RULE_MAX_SAMPLES]; /**< Buffer circular con las muestras de la ventana. */
+    size_t first;                                 /**< Índice de la muestra más antigua. */
+    size_t count;                                 /**< Muestras en la ventana. */
+};
+
+/**
+ * @brief Evento que espera a su acción; copia todo lo necesario para ejecutarla.
+ */
+struct rule_event
+{
+    char rule[CONFIG_RULE_NAME_SIZE];       /**< Nombre de la regla. */
+    char metric[CONFIG_RULE_METRIC_SIZE];   /**< Métrica observada. */
+    bool firing;                            /**< true al disparar, false al resolverse. */
+    double value;                           /**< Valor comparado. */
+    double time;                            /**< Momento del evento. */
+    char webhook[CONFIG_RULE_ACTION_SIZE];  /**< URL del webhook (vacía si no tiene). */
+    char exec[CONFIG_RULE_ACTION_SIZE];     /**< Programa a ejecutar (vacío si no tiene). */
+};
+
+/** Reglas activas y las de la configuración anterior, sólo usadas por el hilo de recolección */
+static struct rule rules[CONFIG_MAX_RULES];
+static struct rule previous_rules[CONFIG_MAX_RULES];
+static size_t rule_count = 0;
+static const struct config* current_config = NULL;
+
+/** Cola de eventos entre el hilo de recolección y el de acciones */
+static struct rule_event events[RULE_EVENT_QUEUE_SIZE];
+static size_t event_first = 0;
+static size_t event_count = 0;
+static pthread_mutex_t event_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t event_ready = PTHREAD_COND_INITIALIZER;
+
+static atomic_ullong actions_ok;
+static atomic_ullong actions_failed;
+static atomic_ullong actions_dropped;
+
+/** Máscara de señales que reciben los programas ejecutados */
+static sigset_t exec_sigmask;
+
+/**
+ * @brief Encola el evento de una regla sin esperar; si la cola está llena lo descarta.
+ */
+static void enqueue_event(const struct rule* rule, bool firing, double time)
+{
+    if (rule->config.webhook[0] == '\0' && rule->config.exec[0] == '\0')
+    {
+        return;
+    }
+
+    pthread_mutex_lock(&event_lock);
+    if (event_count == RULE_EVENT_QUEUE_SIZE)
+    {
+        pthread_mutex_unlock(&event_lock);
+        atomic_fetch_add(&actions_dropped, 1);
+        return;
+    }
+
+    struct rule_event* event = &events[(event_first + event_count) % RULE_EVENT_QUEUE_SIZE];
+    strcpy(event->rule, rule->config.name);
+    strcpy(event->metric, rule->config.metric);
+    event->firing = firing;
+    event->value = rule->value;
+    event->time = time;
+    strcpy(event->webhook, rule->config.webhook);
+    strcpy(event->exec, rule->config.exec);
+    event_count++;
+
+    pthread_cond_signal(&event_ready);
+    pthread_mutex_unlock(&event_lock);
+}
+
+static bool compare(enum rule_op op, double value, double threshold)
+{
+    switch (op)
+    {
+    case RULE_GT:
+        return value > threshold;
+    case RULE_GE:
+        return value >= threshold;
+    case RULE_LT:
+        return value < threshold;
+    case RULE_LE:
+        return value <= threshold;
+    case RULE_EQ:
+        return value == threshold;
+    case RULE_NE:
+        return value != threshold;
+    }
+    return false;
+}
+
+/**
+ * @brief Agrega una muestra a la ventana y devuelve el aumento por segundo dentro de ella.
+ *
+ * Se conserva una sola muestra anterior al comienzo de la ventana, para que la tasa cubra la
+ * ventana completa aunque las muestras estén espaciadas. Si el valor baja (reinicio del
+ * contador) la ventana vuelve a empezar.
+ *
+ * Las muestras guardadas, salvo la última, están separadas al menos por window /
+ * (RULE_MAX_SAMPLES - 3) segundos: mientras la última esté más cerca que eso de la penúltima, la
+ * muestra nueva la reemplaza en lugar de agregarse. Así la ventana entera entra en el buffer
+ * aunque el intervalo sea mucho menor que "rate".
+ *
+ * @return Tasa por segundo, o NaN si todavía no hay dos muestras.
+ */
+static double push_rate_sample(struct rule* rule, double time, double value)
+{
+    if (rule->count > 0 && value < rule->samples[(rule->first + rule->count - 1) % RULE_MAX_SAMPLES].value)
+    {
+        rule->count = 0;
+    }
+
+    double step = rule->config.rate_window / (RULE_MAX_SAMPLES - 3);
+    size_t last = (rule->first + rule->count - 1) % RULE_MAX_SAMPLES;
+    if (rule->count >= 2 &&
+        rule->samples[last].time - rule->samples[(last + RULE_MAX_SAMPLES - 1) % RULE_MAX_SAMPLES].time < step)
+    {
+        rule->count--;
+    }
+    else if (rule->count == RULE_MAX_SAMPLES)
+    {
+        rule->first = (rule->first + 1) % RULE_MAX_SAMPLES;
+        rule->count--;
+    }
+    rule->samples[(rule->first + rule->count) % RULE_MAX_SAMPLES] = (struct rule_sample){time, value};
+    rule->count++;
+
+    while (rule->count > 2 && rule->samples[(rule->first + 1) % RULE_MAX_SAMPLES].time <= time - rule->config.rate_window)
+    {
+        rule->first = (rule->first + 1) % RULE_MAX_SAMPLES;
+        rule->count--;
+    }
+
+    if (rule->count < 2)
+    {
+        return NAN;
+    }
+    const struct rule_sample* oldest = &rule->samples[rule->first];
+    return (value - oldest->value) / (time - oldest->time);
+}
+
+/**
+ * @brief Evalúa una regla con una muestra nueva de su serie.
+ */
+static void evaluate(struct rule* rule, double time, double value)
+{
+    // Varias muestras en un mismo ciclo cuentan como una; si el tiempo retrocede (p. ej. al
+    // reproducir una captura en bucle) la ventana y la espera de "for" vuelven a empezar
+    if (time == rule->last_time)
+    {
+        return;
+    }
+    if (time < rule->last_time)
+    {
+        rule->count = 0;
+        if (rule->state == RULE_PENDING)
+        {
+            rule->state = RULE_INACTIVE;
+        }
+    }
+    rule->last_time = time;
+
+    // NaN llega cuando la serie se marca como obsoleta: la regla se resuelve y la ventana vuelve a empezar
+    if (isnan(value))
+    {
+        rule->count = 0;
+        rule->value = NAN;
+    }
+    else
+    {
+        rule->value = rule->config.rate_window > 0 ? push_rate_sample(rule, time, value) : value;
+    }
+    bool active = !isnan(rule->value) && compare(rule->config.op, rule->value, rule->config.threshold);
+
+    if (!active)
+    {
+        if (rule->state == RULE_FIRING)
+        {
+            enqueue_event(rule, false, time);
+        }
+        rule->state = RULE_INACTIVE;
+        return;
+    }
+
+    if (rule->state == RULE_INACTIVE)
+    {
+        rule->state = RULE_PENDING;
+        rule->since = time;
+    }
+    if (rule->state == RULE_PENDING && time - rule->since >= rule->config.for_seconds)
+    {
+        rule->state = RULE_FIRING;
+        rule->fired++;
+        enqueue_event(rule, true, time);
+    }
+}
+
+/**
+ * @brief Recibe cada muestra de las familias observadas y evalúa las reglas de esa serie.
+ */
+static void on_sample(int family, const char** label_values, double value)
+{
+    double time = proc_source_tick_time();
+
+    for (size_t r = 0; r < rule_count; r++)
+    {
+        struct rule* rule = &rules[r];
+        if (rule->family != family)
+        {
+            continue;
+        }
+
+        size_t i = 0;
+        while (i < rule->config.label_count && strcmp(label_values[i], rule->config.label_values[rule->match[i]]) == 0)
+        {
+            i++;
+        }
+        if (i == rule->config.label_count)
+        {
+            evaluate(rule, time, value);
+        }
+    }
+}
+
+/**
+ * @brief Resuelve la familia de una regla y el orden de sus etiquetas.
+ *
+ * @return 0 si la regla observa una serie concreta, o -1 si no.
+ */
+static int bind_rule(struct rule* rule)
+{
+    const char* keys[SERIES_MAX_LABELS];
+
+    rule->family = series_family_find(rule->config.metric);
+    if (rule->family < 0)
+    {
+        fprintf(stderr, "Regla %s: métrica desconocida %s\n", rule->config.name, rule->config.metric);
+        return -1;
+    }
+
+    // La regla debe dar el valor de todas las etiquetas: observa una sola serie
+    size_t key_count = series_family_label_keys(rule->family, keys);
+    if (key_count != rule->config.label_count)
+    {
+        fprintf(stderr, "Regla %s: %s tiene %zu etiquetas y la regla da %zu\n", rule->config.name,
+                rule->config.metric, key_count, rule->config.label_count);
+        return -1;
+    }
+    for (size_t k = 0; k < key_count; k++)
+    {
+        size_t i = 0;
+        while (i < rule->config.label_count && strcmp(rule->config.label_keys[i], keys[k]) != 0)
+        {
+            i++;
+        }
+        if (i == rule->config.label_count)
+        {
+            fprintf(stderr, "Regla %s: falta la etiqueta %s\n", rule->config.name, keys[k]);
+            return -1;
+        }
+        rule->match[k] = (unsigned char)i;
+    }
+    return 0;
+}
+
+/**
+ * @brief Indica si dos reglas observan la misma serie con la misma ventana.
+ */
+static bool same_series(const struct rule* a, const struct rule* b)
+{
+    if (a->family != b->family || a->config.rate_window != b->config.rate_window)
+    {
+        return false;
+    }
+    for (size_t k = 0; k < a->config.label_count; k++)
+    {
+        if (strcmp(a->config.label_values[a->match[k]], b->config.label_values[b->match[k]]) != 0)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+void rules_configure(const struct config* config)
+{
+    if (config == current_config)
+    {
+        return;
+    }
+    current_config = config;
+
+    // Los hooks sólo los lee este mismo hilo al actualizar las series
+    size_t previous_count = rule_count;
+    bool carried[CONFIG_MAX_RULES] = {false};
+    memcpy(previous_rules, rules, previous_count * sizeof(rules[0]));
+    for (size_t r = 0; r < previous_count; r++)
+    {
+        series_family_set_hook(previous_rules[r].family, NULL);
+    }
+
+    rule_count = 0;
+    for (size_t c = 0; c < config->rule_count; c++)
+    {
+        struct rule* rule = &rules[rule_count];
+        memset(rule, 0, sizeof(*rule));
+        rule->config = config->rules[c];
+        if (bind_rule(rule) != 0)
+        {
+            continue;
+        }
+
+        // Una regla que sigue observando la misma serie conserva su estado y su ventana
+        for (size_t p = 0; p < previous_count; p++)
+        {
+            const struct rule* previous = &previous_rules[p];
+            if (!carried[p] && strcmp(previous->config.name, rule->config.name) == 0 && same_series(previous, rule))
+            {
+                rule->state = previous->state;
+                rule->since = previous->since;
+                rule->value = previous->value;
+                rule->last_time = previous->last_time;
+                rule->fired = previous->fired;
+                memcpy(rule->samples, previous->samples, sizeof(rule->samples));
+                rule->first = previous->first;
+                rule->count = previous->count;
+                carried[p] = true;
+                break;
+            }
+        }
+
+        series_family_set_hook(rule->family, on_sample);
+        rule_count++;
+    }
+
+    // Las alertas que dejan de existir se dan por resueltas
+    for (size_t p = 0; p < previous_count; p++)
+    {
+        if (!carried[p] && previous_rules[p].state == RULE_FIRING)
+        {
+            enqueue_event(&previous_rules[p], false, proc_source_tick_time());
+        }
+    }
+}
+
+size_t rules_expire(const struct config* config)
+{
+    double time = proc_source_tick_time();
+    double period = config->adaptive ? config->max_interval : config->interval;
+    size_t expired = 0;
+
+    for (size_t r = 0; r < rule_count; r++)
+    {
+        struct rule* rule = &rules[r];
+        if (rule->last_time == 0 || time - rule->last_time < RULE_STALE_PERIODS * period ||
+            (rule->state == RULE_INACTIVE && rule->count == 0 && isnan(rule->value)))
+        {
+            continue;
+        }
+        if (rule->state == RULE_FIRING)
+        {
+            enqueue_event(rule, false, time);
+        }
+        expired++;
+        rule->state = RULE_INACTIVE;
+        rule->value = NAN;
+        rule->count = 0;
+    }
+    return expired;
+}
+
+size_t rules_get_status(struct rule_status* status, size_t max_rules)
+{
+    size_t count = rule_count < max_rules ? rule_count : max_rules;
+    for (size_t r = 0; r < count; r++)
+    {
+        status[r].name = rules[r].config.name;
+        status[r].state = rules[r].state;
+        status[r].value = rules[r].value;
+        status[r].fired = rules[r].fired;
+    }
+    return count;
+}
+
+void rules_get_action_stats(struct rule_action_stats* stats)
+{
+    stats->ok = atomic_load(&actions_ok);
+    stats->failed = atomic_load(&actions_failed);
+    stats->dropped = atomic_load(&actions_dropped);
+}
+
+/**
+ * @brief Escribe un valor como número JSON (null si no es finito).
+ */
+static void format_value(char* text, size_t size, double value)
+{
+    if (isfinite(value))
+    {
+        snprintf(text, size, "%.17g", value);
+    }
+    else
+    {
+        snprintf(text, size, "null");
+    }
+}
+
+/**
+ * @brief Copia una cadena escapando '"' y '\\' para incluirla en un string JSON.
+ */
+static void json_escape(char* dest, size_t size, const char* src)
+{
+    size_t len = 0;
+    for (; *src != '\0' && len + 2 < size; src++)
+    {
+        if (*src == '"' || *src == '\\')
+        {
+            dest[len++] = '\\';
+        }
+        dest[len++] = (unsigned char)*src < 0x20 ? ' ' : *src;
+    }
+    dest[len] = '\0';
+}
+
+/**
+ * @brief Envía un evento por POST a un webhook http://host[:puerto]/ruta.
+ *
+ * @return 0 si el webhook respondió 2xx, o -1 en caso de error.
+ */
+static int send_webhook(const struct rule_event* event)
+{
+    char host[WEBHOOK_HOST_SIZE], port[WEBHOOK_PORT_SIZE] = "80";
+    const char* authority = event->webhook + strlen("http://");
+    const char* path = strchr(authority, '/');
+    size_t authority_len = path != NULL ? (size_t)(path - authority) : strlen(authority);
+    if (path == NULL)
+    {
+        path = "/";
+    }
+
+    const char* colon = memchr(authority, ':', authority_len);
+    size_t host_len = colon != NULL ? (size_t)(colon - authority) : authority_len;
+    if (host_len == 0 || host_len >= sizeof(host) ||
+        (colon != NULL && (size_t)(authority + authority_len - colon - 1) >= sizeof(port)))
+    {
+        fprintf(stderr, "Regla %s: URL de webhook inválida %s\n", event->rule, event->webhook);
+        return -1;
+    }
+    memcpy(host, authority, host_len);
+    host[host_len] = '\0';
+    if (colon != NULL)
+    {
+        size_t port_len = authority + authority_len - colon - 1;
+        memcpy(port, colon + 1, port_len);
+        port[port_len] = '\0';
+    }
+
+    char rule[CONFIG_RULE_NAME_SIZE * 2], metric[CONFIG_RULE_METRIC_SIZE * 2], value[VALUE_TEXT_SIZE];
+    char body[WEBHOOK_BODY_SIZE], request[WEBHOOK_REQUEST_SIZE];
+    json_escape(rule, sizeof(rule), event->rule);
+    json_escape(metric, sizeof(metric), event->metric);
+    format_value(value, sizeof(value), event->value);
+    int body_len = snprintf(body, sizeof(body),
+                            "{\"rule\":\"%s\",\"metric\":\"%s\",\"state\":\"%s\",\"value\":%s,\"timestamp\":%.3f}\n",
+                            rule, metric, event->firing ? "firing" : "resolved", value, event->time);
+    int request_len = snprintf(request, sizeof(request),
+                               "POST %s HTTP/1.1\r\nHost: %s\r\nContent-Type: application/json\r\n"
+                               "Content-Length: %d\r\nConnection: close\r\n\r\n%s",
+                               path, host, body_len, body);
+    if (request_len < 0 || (size_t)request_len >= sizeof(request))
+    {
+        fprintf(stderr, "Regla %s: el evento no entra en la petición al webhook\n", event->rule);
+        return -1;
+    }
+
+    struct addrinfo hints = {.ai_family = AF_UNSPEC, .ai_socktype = SOCK_STREAM};
+    struct addrinfo* addresses;
+    int ret = getaddrinfo(host, port, &hints, &addresses);
+    if (ret != 0)
+    {
+        fprintf(stderr, "Regla %s: no se pudo resolver %s: %s\n", event->rule, host, gai_strerror(ret));
+        return -1;
+    }
+
+    // En Linux SO_SNDTIMEO también limita la espera de connect()
+    struct timeval timeout = {RULE_WEBHOOK_TIMEOUT, 0};
+    int fd = -1;
+    for (struct addrinfo* address = addresses; address != NULL && fd < 0; address = address->ai_next)
+    {
+        fd = socket(address->ai_family, address->ai_socktype | SOCK_CLOEXEC, address->ai_protocol);
+        if (fd < 0)
+        {
+            continue;
+        }
+        setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+        setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+        if (connect(fd, address->ai_addr, address->ai_addrlen) != 0)
+        {
+            close(fd);
+            fd = -1;
+        }
+    }
+    freeaddrinfo(addresses);
+    if (fd < 0)
+    {
+        fprintf(stderr, "Regla %s: no se pudo conectar con %s\n", event->rule, event->webhook);
+        return -1;
+    }
+
+    char response[WEBHOOK_RESPONSE_SIZE];
+    ssize_t received = -1;
+    if (send(fd, request, request_len, MSG_NOSIGNAL) == request_len)
+    {
+        received = recv(fd, response, sizeof(response) - 1, 0);
+    }
+    close(fd);
+
+    int status = 0;
+    if (received > 0)
+    {
+        response[received] = '\0';
+        sscanf(response, "HTTP/%*s %d", &status);
+    }
+    if (status < 200 || status > 299)
+    {
+        fprintf(stderr, "Regla %s: el webhook %s no aceptó el evento\n", event->rule, event->webhook);
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * @brief Espera a que termine un programa lanzado por una regla, a lo sumo RULE_WEBHOOK_TIMEOUT segundos.
+ *
+ * Al vencer el plazo mata con SIGKILL a su grupo de procesos y lo recoge, para que un programa
+ * colgado no detenga al hilo de acciones ni quede como zombi.
+ *
+ * @return 0 si el programa terminó con código 0, o -1 si falló o no terminó a tiempo.
+ */
+static int wait_exec(const struct rule_event* event, pid_t pid)
+{
+    struct timespec start, now;
+    struct timespec pause = {0, EXEC_POLL_NSEC};
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    int status;
+    while (1)
+    {
+        pid_t ret = waitpid(pid, &status, WNOHANG);
+        if (ret == pid)
+        {
+            break;
+        }
+        if (ret < 0)
+        {
+            perror("Error al esperar el programa de la regla");
+            return -1;
+        }
+
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        if (now.tv_sec - start.tv_sec + (now.tv_nsec - start.tv_nsec) / 1e9 >= RULE_WEBHOOK_TIMEOUT)
+        {
+            kill(-pid, SIGKILL);
+            waitpid(pid, &status, 0);
+            fprintf(stderr, "Regla %s: %s no terminó en %d s y se lo detuvo\n", event->rule, event->exec,
+                    RULE_WEBHOOK_TIMEOUT);
+            return -1;
+        }
+        nanosleep(&pause, NULL);
+    }
+
+    if (!WIFEXITED(status) || WEXITSTATUS(status) != 0)
+    {
+        fprintf(stderr, "Regla %s: %s terminó con error\n", event->rule, event->exec);
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * @brief Ejecuta el programa de una regla con el nombre, el estado y el valor como argumentos.
+ *
+ * @return 0 si el programa terminó con código 0, o -1 en caso de error.
+ */
+static int run_exec(const struct rule_event* event)
+{
+    char value[VALUE_TEXT_SIZE];
+    format_value(value, sizeof(value), event->value);
+    char* argv[] = {(char*)event->exec, (char*)event->rule, event->firing ? "firing" : "resolved", value, NULL};
+
+    // El agente bloquea SIGINT y SIGUSR1; el programa debe poder recibirlas. Corre en su propio grupo
+    // de procesos para que, si no termina a tiempo, se lo pueda matar junto con los que haya lanzado
+    posix_spawnattr_t attr;
+    posix_spawnattr_init(&attr);
+    posix_spawnattr_setsigmask(&attr, &exec_sigmask);
+    posix_spawnattr_setpgroup(&attr, 0);
+    posix_spawnattr_setflags(&attr, POSIX_SPAWN_SETSIGMASK | POSIX_SPAWN_SETPGROUP);
+
+    pid_t pid;
+    int ret = posix_spawn(&pid, event->exec, NULL, &attr, argv, environ);
+    posix_spawnattr_destroy(&attr);
+    if (ret != 0)
+    {
+        fprintf(stderr, "Regla %s: no se pudo ejecutar %s: %s\n", event->rule, event->exec, strerror(ret));
+        return -1;
+    }
+
+    return wait_exec(event, pid);
+}
+
+/**
+ * @brief Hilo que ejecuta las acciones de los eventos encolados, de a uno.
+ */
+static void* run_actions(void* arg)
+{
+    (void)arg;
+    struct rule_event event;
+
+    while (1)
+    {
+        pthread_mutex_lock(&event_lock);
+        while (event_count == 0)
+        {
+            pthread_cond_wait(&event_ready, &event_lock);
+        }
+        event = events[event_first];
+        event_first = (event_first + 1) % RULE_EVENT_QUEUE_SIZE;
+        event_count--;
+        pthread_mutex_unlock(&event_lock);
+
+        if (event.webhook[0] != '\0')
+        {
+            atomic_fetch_add(send_webhook(&event) == 0 ? &actions_ok : &actions_failed, 1);
+        }
+        if (event.exec[0] != '\0')
+        {
+            atomic_fetch_add(run_exec(&event) == 0 ? &actions_ok : &actions_failed, 1);
+        }
+    }
+    return NULL;
+}
+
+int rules_init(void)
+{
+    sigemptyset(&exec_sigmask);
+
+    pthread_t tid;
+    if (pthread_create(&tid, NULL, run_actions, NULL) != 0)
+    {
+        fprintf(stderr, "Error al crear el hilo de acciones de las reglas\n");
+        return -1;
+    }
+    pthread_detach(tid);
+    return 0;
+}
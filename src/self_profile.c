@@ -0,0 +1,373 @@
+#define _GNU_SOURCE // RUSAGE_THREAD
+
+#include "../include/self_profile.h"
+#include <linux/perf_event.h>
+#include <errno.h>
+#include <limits.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+#define NSEC_PER_SEC 1000000000ULL
+
+/** Estados del descriptor de eventos de un hilo, además de un descriptor válido */
+#define PERF_UNOPENED -2
+#define PERF_UNAVAILABLE -1
+
+/**
+ * Contadores que se leen con perf_event, los primeros de enum self_profile_counter. Los cambios de
+ * contexto se toman siempre de getrusage: con exclude_kernel el evento de software los cuenta en 0,
+ * porque ocurren dentro del kernel, y sin exclude_kernel perf_event_paranoid >= 2 rechaza el grupo
+ */
+#define PERF_COUNTERS SELF_PROFILE_CONTEXT_SWITCHES
+
+#define PERF_PARANOID_PATH "/proc/sys/kernel/perf_event_paranoid"
+#define PROFILE_MODE_SIZE 256
+
+/**
+ * @brief Costo acumulado de una sección; la actualizan todos los hilos que la ejecutan.
+ */
+struct section
+{
+    const char* name;                                         /**< Nombre de la sección. */
+    atomic_ullong calls;                                      /**< Veces que se ejecutó. */
+    atomic_ullong totals[SELF_PROFILE_COUNTER_COUNT];         /**< Suma de cada contador. */
+    atomic_ullong max_task_clock;                             /**< Ejecución más cara, en nanosegundos. */
+};
+
+static struct section sections[SELF_PROFILE_MAX_SECTIONS];
+static atomic_size_t section_count = 0;
+static atomic_bool enabled = false;
+
+/** Hilos vivos que leen sus contadores con perf_event o con getrusage */
+static atomic_uint perf_threads = 0;
+static atomic_uint rusage_threads = 0;
+
+/** errno del primer perf_event_open() rechazado, o 0 si ninguno falló */
+static atomic_int perf_errno = 0;
+
+/** Muestras descartadas porque no se pudieron leer los contadores al empezar o al terminar */
+static atomic_ullong skipped_samples = 0;
+
+/** Líder del grupo de eventos del hilo actual (task-clock), o PERF_UNOPENED/PERF_UNAVAILABLE */
+static __thread int perf_fd = PERF_UNOPENED;
+
+/** Descriptores del grupo del hilo actual, que se cierran cuando el hilo termina */
+static __thread int perf_fds[PERF_COUNTERS];
+
+static pthread_key_t thread_key;
+static pthread_once_t thread_key_once = PTHREAD_ONCE_INIT;
+
+int self_profile_section(const char* name)
+{
+    size_t count = atomic_load(&section_count);
+    for (size_t i = 0; i < count; i++)
+    {
+        if (strcmp(sections[i].name, name) == 0)
+        {
+            return (int)i;
+        }
+    }
+    if (count == SELF_PROFILE_MAX_SECTIONS)
+    {
+        fprintf(stderr, "No quedan secciones de perfilado para %s\n", name);
+        return -1;
+    }
+
+    // El nombre se escribe antes de publicar la sección a los hilos que generan /debug/profile
+    sections[count].name = name;
+    atomic_store(&section_count, count + 1);
+    return (int)count;
+}
+
+void self_profile_set_enabled(bool value)
+{
+    atomic_store_explicit(&enabled, value, memory_order_relaxed);
+}
+
+bool self_profile_enabled(void)
+{
+    return atomic_load_explicit(&enabled, memory_order_relaxed);
+}
+
+/**
+ * @brief Abre un contador de software del hilo actual dentro del grupo indicado.
+ *
+ * @return Descriptor del contador, o -1 en caso de error.
+ */
+static int open_counter(unsigned long long counter, int group_fd)
+{
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = PERF_TYPE_SOFTWARE;
+    attr.config = counter;
+    attr.read_format = PERF_FORMAT_GROUP;
+
+    // Sólo lo que ocurre en modo usuario: es lo que permite perf_event_paranoid 2 (el valor por
+    // defecto de muchas distribuciones) sin CAP_PERFMON
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+
+    // pid 0 y cpu -1: sólo este hilo, en cualquier CPU; los hilos que cree no lo heredan
+    return (int)syscall(SYS_perf_event_open, &attr, 0, -1, group_fd, PERF_FLAG_FD_CLOEXEC);
+}
+
+/**
+ * @brief Cierra los eventos de un hilo que termina (p. ej. un hilo por conexión del servidor HTTP).
+ */
+static void close_thread_counters(void* fds)
+{
+    if (fds == (void*)perf_fds)
+    {
+        for (int c = 0; c < PERF_COUNTERS; c++)
+        {
+            close(perf_fds[c]);
+        }
+        atomic_fetch_sub(&perf_threads, 1);
+    }
+    else
+    {
+        atomic_fetch_sub(&rusage_threads, 1);
+    }
+}
+
+static void create_thread_key(void)
+{
+    pthread_key_create(&thread_key, close_thread_counters);
+}
+
+/**
+ * @brief Abre el grupo de eventos del hilo actual, en el orden de enum self_profile_counter.
+ */
+static void open_thread_counters(void)
+{
+    static const unsigned long long counters[PERF_COUNTERS] = {PERF_COUNT_SW_TASK_CLOCK, PERF_COUNT_SW_PAGE_FAULTS};
+
+    pthread_once(&thread_key_once, create_thread_key);
+
+    int opened = 0;
+    while (opened < PERF_COUNTERS)
+    {
+        perf_fds[opened] = open_counter(counters[opened], opened == 0 ? -1 : perf_fds[0]);
+        if (perf_fds[opened] < 0)
+        {
+            break;
+        }
+        opened++;
+    }
+
+    if (opened < PERF_COUNTERS)
+    {
+        // Si el kernel no lo permite, no lo permitirá en ningún hilo: basta con avisar una vez
+        int expected = 0;
+        if (atomic_compare_exchange_strong(&perf_errno, &expected, errno))
+        {
+            perror("perf_event_open (se usará getrusage)");
+        }
+        while (opened > 0)
+        {
+            close(perf_fds[--opened]);
+        }
+        perf_fd = PERF_UNAVAILABLE;
+        atomic_fetch_add(&rusage_threads, 1);
+        pthread_setspecific(thread_key, &perf_fd);
+        return;
+    }
+
+    // Los miembros del grupo se leen a través del líder y viven mientras viva el hilo
+    perf_fd = perf_fds[0];
+    atomic_fetch_add(&perf_threads, 1);
+    pthread_setspecific(thread_key, perf_fds);
+}
+
+/**
+ * @brief Lee los contadores acumulados del hilo actual.
+ *
+ * Un hilo lee siempre de la misma fuente: si falla el read() del grupo no se completa con
+ * getrusage, porque restar lecturas de fuentes distintas daría una diferencia sin sentido.
+ *
+ * @return 0 en caso de éxito, o -1 si no se pudieron leer.
+ */
+static int read_thread_counters(unsigned long long* values)
+{
+    struct rusage usage;
+    if (getrusage(RUSAGE_THREAD, &usage) != 0)
+    {
+        return -1;
+    }
+    values[SELF_PROFILE_CONTEXT_SWITCHES] = usage.ru_nvcsw + usage.ru_nivcsw;
+
+    if (perf_fd >= 0)
+    {
+        // Con PERF_FORMAT_GROUP: cantidad de eventos seguida de sus valores
+        unsigned long long group[1 + PERF_COUNTERS];
+        if (read(perf_fd, group, sizeof(group)) != (ssize_t)sizeof(group))
+        {
+            return -1;
+        }
+        memcpy(values, group + 1, PERF_COUNTERS * sizeof(values[0]));
+        return 0;
+    }
+
+    struct timespec ts;
+    if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts) != 0)
+    {
+        return -1;
+    }
+    values[SELF_PROFILE_TASK_CLOCK] = (unsigned long long)ts.tv_sec * NSEC_PER_SEC + ts.tv_nsec;
+    values[SELF_PROFILE_PAGE_FAULTS] = usage.ru_minflt + usage.ru_majflt;
+    return 0;
+}
+
+void self_profile_begin(struct self_profile_sample* start)
+{
+    start->valid = self_profile_enabled();
+    if (!start->valid)
+    {
+        return;
+    }
+    if (perf_fd == PERF_UNOPENED)
+    {
+        open_thread_counters();
+    }
+    if (read_thread_counters(start->values) != 0)
+    {
+        start->valid = false;
+        atomic_fetch_add_explicit(&skipped_samples, 1, memory_order_relaxed);
+    }
+}
+
+void self_profile_end(int section, const struct self_profile_sample* start)
+{
+    if (!start->valid || section < 0)
+    {
+        return;
+    }
+
+    unsigned long long values[SELF_PROFILE_COUNTER_COUNT];
+    if (read_thread_counters(values) != 0)
+    {
+        atomic_fetch_add_explicit(&skipped_samples, 1, memory_order_relaxed);
+        return;
+    }
+
+    struct section* s = &sections[section];
+    atomic_fetch_add_explicit(&s->calls, 1, memory_order_relaxed);
+    for (int c = 0; c < SELF_PROFILE_COUNTER_COUNT; c++)
+    {
+        atomic_fetch_add_explicit(&s->totals[c], values[c] - start->values[c], memory_order_relaxed);
+    }
+
+    unsigned long long task_clock = values[SELF_PROFILE_TASK_CLOCK] - start->values[SELF_PROFILE_TASK_CLOCK];
+    unsigned long long max = atomic_load_explicit(&s->max_task_clock, memory_order_relaxed);
+    while (task_clock > max &&
+           !atomic_compare_exchange_weak_explicit(&s->max_task_clock, &max, task_clock, memory_order_relaxed,
+                                                  memory_order_relaxed))
+    {
+    }
+}
+
+/**
+ * @brief Lee /proc/sys/kernel/perf_event_paranoid.
+ *
+ * @return El nivel configurado, o INT_MIN si no se pudo leer.
+ */
+static int read_perf_paranoid(void)
+{
+    FILE* fp = fopen(PERF_PARANOID_PATH, "r");
+    if (fp == NULL)
+    {
+        return INT_MIN;
+    }
+    int level;
+    if (fscanf(fp, "%d", &level) != 1)
+    {
+        level = INT_MIN;
+    }
+    fclose(fp);
+    return level;
+}
+
+/**
+ * @brief Describe qué fuente usan los hilos para sus contadores y, si no es perf_event, por qué.
+ */
+static void describe_mode(char* mode, size_t size)
+{
+    int error = atomic_load(&perf_errno);
+    if (error == 0)
+    {
+        snprintf(mode, size, "perf_event con exclude_kernel (page_faults sólo de modo usuario); ctx_switches de getrusage");
+        return;
+    }
+
+    // Con exclude_kernel basta perf_event_paranoid <= 2; si ya lo es, el rechazo viene de otro lado
+    int paranoid = read_perf_paranoid();
+    const char* reason;
+    if (error == ENOSYS || error == ENOENT)
+    {
+        reason = "el kernel no tiene perf_event";
+    }
+    else if (paranoid > 2)
+    {
+        reason = "se necesita perf_event_paranoid <= 2 o CAP_PERFMON";
+    }
+    else
+    {
+        reason = "lo impide seccomp o la política del contenedor";
+    }
+    if (paranoid == INT_MIN)
+    {
+        snprintf(mode, size, "getrusage (perf_event_open: %s)", strerror(error));
+        return;
+    }
+    snprintf(mode, size, "getrusage (perf_event_open: %s; perf_event_paranoid = %d: %s)", strerror(error), paranoid,
+             reason);
+}
+
+size_t self_profile_render(char* buffer, size_t size)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+    double process_seconds = ts.tv_sec + ts.tv_nsec / 1e9;
+
+    char mode[PROFILE_MODE_SIZE];
+    describe_mode(mode, sizeof(mode));
+
+    size_t len = 0;
+    int n = snprintf(buffer, size,
+                     "# Modo: %s\n"
+                     "# Hilos con perf_event: %u, con getrusage: %u; muestras descartadas: %llu; CPU del proceso: %.3f s\n"
+                     "# %-22s %10s %10s %7s %12s %12s %12s %12s\n",
+                     mode, atomic_load(&perf_threads), atomic_load(&rusage_threads),
+                     atomic_load_explicit(&skipped_samples, memory_order_relaxed), process_seconds, "sección",
+                     "llamadas", "cpu_s", "%cpu", "us/llamada", "max_us", "page_faults", "ctx_switches");
+    len = n < 0 ? 0 : ((size_t)n < size ? (size_t)n : size - 1);
+
+    size_t count = atomic_load(&section_count);
+    for (size_t i = 0; i < count && len + 1 < size; i++)
+    {
+        struct section* s = &sections[i];
+        unsigned long long calls = atomic_load_explicit(&s->calls, memory_order_relaxed);
+        double cpu_seconds =
+            atomic_load_explicit(&s->totals[SELF_PROFILE_TASK_CLOCK], memory_order_relaxed) / (double)NSEC_PER_SEC;
+
+        n = snprintf(buffer + len, size - len, "%-24s %10llu %10.4f %7.2f %12.1f %12.1f %12llu %12llu\n", s->name,
+                     calls, cpu_seconds, process_seconds > 0 ? cpu_seconds / process_seconds * 100.0 : 0.0,
+                     calls > 0 ? cpu_seconds / calls * 1e6 : 0.0,
+                     atomic_load_explicit(&s->max_task_clock, memory_order_relaxed) / 1e3,
+                     atomic_load_explicit(&s->totals[SELF_PROFILE_PAGE_FAULTS], memory_order_relaxed),
+                     atomic_load_explicit(&s->totals[SELF_PROFILE_CONTEXT_SWITCHES], memory_order_relaxed));
+        if (n < 0)
+        {
+            break;
+        }
+        len += (size_t)n < size - len ? (size_t)n : size - len - 1;
+    }
+    return len;
+}
@@ -0,0 +1,1262 @@
+#include "../include/series.h"
+#include <math.h>
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define NONE UINT32_MAX
+#define FAMILY_NAME_SIZE 128
+#define FAMILY_HELP_SIZE 256
+#define MIN_INTERN_CAPACITY 64
+#define BUFFER_INITIAL_SIZE 4096
+#define COUNTER_SUFFIX "_total"
+
+/**
+ * @brief Estado de un lugar de la tabla de series.
+ */
+enum series_state
+{
+    SERIES_FREE,   /**< Lugar libre. */
+    SERIES_ACTIVE, /**< Serie expuesta. */
+    SERIES_STALE   /**< Serie que desapareció de su colector; no se expone. */
+};
+
+/**
+ * @brief Familia de métricas: nombre, descripción, tipo y nombres de etiquetas.
+ */
+struct family
+{
+    char name[FAMILY_NAME_SIZE];                          /**< Nombre de la métrica. */
+    char help[FAMILY_HELP_SIZE];                          /**< Descripción de la métrica. */
+    enum series_type type;                                /**< Tipo de la métrica. */
+    size_t label_count;                                   /**< Cantidad de etiquetas. */
+    char label_keys[SERIES_MAX_LABELS][SERIES_LABEL_SIZE]; /**< Nombres de las etiquetas. */
+    unsigned int generation;                              /**< Pasada actual del colector. */
+    uint32_t head;                                        /**< Primera serie de la familia. */
+    uint32_t tail;                                        /**< Última serie de la familia. */
+    double created;                                       /**< Creación fija de sus series (0 = al crearlas). */
+    uint32_t exemplar_series;                             /**< Serie del ejemplar (NONE si no tiene). */
+    char exemplar_key[SERIES_LABEL_SIZE];                 /**< Etiqueta del ejemplar. */
+    char exemplar_value[SERIES_LABEL_SIZE];               /**< Valor de la etiqueta del ejemplar. */
+    double exemplar_sample;                               /**< Valor observado del ejemplar. */
+    double exemplar_time;                                 /**< Momento del ejemplar (segundos desde la época). */
+    series_sample_hook hook;                              /**< Función que observa sus muestras (o NULL). */
+    bool self;                                            /**< Sus valores no cambian la versión. */
+};
+
+/**
+ * @brief Serie: valores de etiquetas internados y último valor.
+ *
+ * Cada serie pertenece a tres listas enlazadas por índice: la cadena de su bucket en la tabla
+ * hash, la lista de su familia (orden de exposición) y la lista LRU (sólo si tiene etiquetas).
+ */
+struct series
+{
+    uint32_t labels[SERIES_MAX_LABELS]; /**< Índices de los valores internados. */
+    double value;                       /**< Último valor. */
+    double created;                     /**< Momento de creación (segundos desde la época). */
+    unsigned int generation;            /**< Pasada en la que se actualizó por última vez. */
+    uint32_t hash_next;                 /**< Siguiente en el bucket (o en la lista libre). */
+    uint32_t lru_prev;                  /**< Serie actualizada más recientemente. */
+    uint32_t lru_next;                  /**< Serie actualizada hace más tiempo. */
+    uint32_t family_prev;               /**< Serie anterior de la familia. */
+    uint32_t family_next;               /**< Serie siguiente de la familia. */
+    uint16_t family;                    /**< Familia de la serie. */
+    uint8_t state;                      /**< Valor de enum series_state. */
+};
+
+/**
+ * @brief Valor de etiqueta internado, compartido por todas las series que lo usan.
+ */
+struct interned
+{
+    char value[SERIES_LABEL_SIZE]; /**< Valor de la etiqueta. */
+    uint32_t hash;                 /**< Hash del valor. */
+    uint32_t refcount;             /**< Series que lo referencian (0 = libre). */
+    uint32_t hash_next;            /**< Siguiente en el bucket (o en la lista libre). */
+};
+
+static struct family families[SERIES_MAX_FAMILIES];
+static size_t family_count = 0;
+
+static struct series* series_slots = NULL;
+static uint32_t* series_buckets = NULL;
+static size_t series_bucket_mask = 0;
+static uint32_t series_free = NONE;
+
+static struct interned* intern_slots = NULL;
+static uint32_t* intern_buckets = NULL;
+static size_t intern_bucket_mask = 0;
+static uint32_t intern_free = NONE;
+
+/** Extremos de la lista LRU: head es la serie actualizada más recientemente */
+static uint32_t lru_head = NONE;
+static uint32_t lru_tail = NONE;
+
+static struct series_stats stats;
+
+/** Versión de la tabla: cambia sólo cuando cambia lo que se expone (valores, series o ejemplares) */
+static unsigned long long version = 0;
+
+/** Versión de los valores de las familias del agente, que no cambian version */
+static unsigned long long self_version = 0;
+
+/**
+ * @brief Hash FNV-1a de una cadena.
+ */
+static uint32_t hash_string(const char* value)
+{
+    uint32_t hash = 2166136261u;
+    for (; *value != '\0'; value++)
+    {
+        hash = (hash ^ (unsigned char)*value) * 16777619u;
+    }
+    return hash;
+}
+
+/**
+ * @brief Hash de una serie a partir de su familia y de los índices de sus etiquetas.
+ */
+static uint32_t hash_series(int family, const uint32_t* labels, size_t label_count)
+{
+    uint32_t hash = 2166136261u ^ (uint32_t)family;
+    for (size_t i = 0; i < label_count; i++)
+    {
+        hash = (hash ^ labels[i]) * 16777619u;
+    }
+    return hash * 16777619u;
+}
+
+/**
+ * @brief Devuelve la menor potencia de dos mayor o igual que n.
+ */
+static size_t next_power_of_two(size_t n)
+{
+    size_t power = 1;
+    while (power < n)
+    {
+        power <<= 1;
+    }
+    return power;
+}
+
+/**
+ * @brief Devuelve la hora actual en segundos.
+ */
+static double now_seconds(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static uint32_t intern_find(const char* value, uint32_t hash)
+{
+    for (uint32_t id = intern_buckets[hash & intern_bucket_mask]; id != NONE; id = intern_slots[id].hash_next)
+    {
+        if (intern_slots[id].hash == hash && strcmp(intern_slots[id].value, value) == 0)
+        {
+            return id;
+        }
+    }
+    return NONE;
+}
+
+/**
+ * @brief Obtiene una referencia a un valor internado, creándolo si hace falta.
+ *
+ * @return Índice del valor, o NONE si el espacio de etiquetas está lleno.
+ */
+static uint32_t intern_acquire(const char* value)
+{
+    uint32_t hash = hash_string(value);
+    uint32_t id = intern_find(value, hash);
+    if (id != NONE)
+    {
+        intern_slots[id].refcount++;
+        return id;
+    }
+
+    id = intern_free;
+    if (id == NONE)
+    {
+        return NONE;
+    }
+    intern_free = intern_slots[id].hash_next;
+
+    struct interned* entry = &intern_slots[id];
+    strcpy(entry->value, value);
+    entry->hash = hash;
+    entry->refcount = 1;
+    entry->hash_next = intern_buckets[hash & intern_bucket_mask];
+    intern_buckets[hash & intern_bucket_mask] = id;
+    return id;
+}
+
+/**
+ * @brief Libera una referencia a un valor internado.
+ */
+static void intern_release(uint32_t id)
+{
+    struct interned* entry = &intern_slots[id];
+    if (--entry->refcount > 0)
+    {
+        return;
+    }
+
+    uint32_t* link = &intern_buckets[entry->hash & intern_bucket_mask];
+    while (*link != id)
+    {
+        link = &intern_slots[*link].hash_next;
+    }
+    *link = entry->hash_next;
+
+    entry->hash_next = intern_free;
+    intern_free = id;
+}
+
+static void lru_unlink(uint32_t idx)
+{
+    struct series* s = &series_slots[idx];
+    if (s->lru_prev != NONE)
+    {
+        series_slots[s->lru_prev].lru_next = s->lru_next;
+    }
+    else
+    {
+        lru_head = s->lru_next;
+    }
+    if (s->lru_next != NONE)
+    {
+        series_slots[s->lru_next].lru_prev = s->lru_prev;
+    }
+    else
+    {
+        lru_tail = s->lru_prev;
+    }
+    s->lru_prev = s->lru_next = NONE;
+}
+
+static void lru_push_front(uint32_t idx)
+{
+    struct series* s = &series_slots[idx];
+    s->lru_prev = NONE;
+    s->lru_next = lru_head;
+    if (lru_head != NONE)
+    {
+        series_slots[lru_head].lru_prev = idx;
+    }
+    lru_head = idx;
+    if (lru_tail == NONE)
+    {
+        lru_tail = idx;
+    }
+}
+
+/**
+ * @brief Quita una serie de la tabla y devuelve su lugar a la lista libre.
+ */
+static void remove_series(uint32_t idx)
+{
+    struct series* s = &series_slots[idx];
+    struct family* fam = &families[s->family];
+
+    // Cadena del bucket
+    uint32_t* link = &series_buckets[hash_series(s->family, s->labels, fam->label_count) & series_bucket_mask];
+    while (*link != idx)
+    {
+        link = &series_slots[*link].hash_next;
+    }
+    *link = s->hash_next;
+
+    // Lista de la familia
+    if (s->family_prev != NONE)
+    {
+        series_slots[s->family_prev].family_next = s->family_next;
+    }
+    else
+    {
+        fam->head = s->family_next;
+    }
+    if (s->family_next != NONE)
+    {
+        series_slots[s->family_next].family_prev = s->family_prev;
+    }
+    else
+    {
+        fam->tail = s->family_prev;
+    }
+
+    if (fam->label_count > 0)
+    {
+        lru_unlink(idx);
+    }
+    for (size_t i = 0; i < fam->label_count; i++)
+    {
+        intern_release(s->labels[i]);
+    }
+    if (fam->exemplar_series == idx)
+    {
+        fam->exemplar_series = NONE;
+    }
+
+    if (s->state == SERIES_ACTIVE)
+    {
+        stats.active--;
+    }
+    else
+    {
+        stats.stale--;
+    }
+    s->state = SERIES_FREE;
+    s->hash_next = series_free;
+    version++;
+    series_free = idx;
+}
+
+/**
+ * @brief Desaloja la serie actualizada hace más tiempo.
+ *
+ * @return 0 si se liberó un lugar, o -1 si no hay series desalojables.
+ */
+static int evict_one(void)
+{
+    if (lru_tail == NONE)
+    {
+        return -1;
+    }
+
+    if (series_slots[lru_tail].state == SERIES_ACTIVE)
+    {
+        stats.evictions++;
+        stats.last_evicted_family = series_slots[lru_tail].family;
+    }
+    remove_series(lru_tail);
+    return 0;
+}
+
+/**
+ * @brief Crea una serie nueva, desalojando otras si la tabla o el espacio de etiquetas están llenos.
+ *
+ * @return Índice de la serie, o NONE si no hay lugar.
+ */
+static uint32_t create_series(int family, const char** label_values)
+{
+    struct family* fam = &families[family];
+
+    if (series_free == NONE && evict_one() != 0)
+    {
+        return NONE;
+    }
+    uint32_t idx = series_free;
+    series_free = series_slots[idx].hash_next;
+
+    struct series* s = &series_slots[idx];
+    for (size_t i = 0; i < fam->label_count; i++)
+    {
+        while ((s->labels[i] = intern_acquire(label_values[i])) == NONE)
+        {
+            if (evict_one() != 0)
+            {
+                while (i-- > 0)
+                {
+                    intern_release(s->labels[i]);
+                }
+                s->hash_next = series_free;
+                series_free = idx;
+                return NONE;
+            }
+        }
+    }
+
+    s->family = (uint16_t)family;
+    s->state = SERIES_ACTIVE;
+    s->created = fam->created > 0 ? fam->created : now_seconds();
+    s->value = 0.0;
+
+    uint32_t bucket = hash_series(family, s->labels, fam->label_count) & series_bucket_mask;
+    s->hash_next = series_buckets[bucket];
+    series_buckets[bucket] = idx;
+
+    s->family_next = NONE;
+    s->family_prev = fam->tail;
+    if (fam->tail != NONE)
+    {
+        series_slots[fam->tail].family_next = idx;
+    }
+    else
+    {
+        fam->head = idx;
+    }
+    fam->tail = idx;
+
+    s->lru_prev = s->lru_next = NONE;
+    if (fam->label_count > 0)
+    {
+        lru_push_front(idx);
+    }
+
+    stats.active++;
+    version++;
+    return idx;
+}
+
+int series_table_init(size_t capacity)
+{
+    if (capacity == 0 || capacity >= NONE)
+    {
+        fprintf(stderr, "Capacidad de la tabla de series inválida: %zu\n", capacity);
+        return -1;
+    }
+
+    size_t series_bucket_count = next_power_of_two(capacity);
+    size_t intern_capacity = capacity > MIN_INTERN_CAPACITY ? capacity : MIN_INTERN_CAPACITY;
+    size_t intern_bucket_count = next_power_of_two(intern_capacity);
+
+    series_slots = calloc(capacity, sizeof(*series_slots));
+    series_buckets = malloc(series_bucket_count * sizeof(*series_buckets));
+    intern_slots = calloc(intern_capacity, sizeof(*intern_slots));
+    intern_buckets = malloc(intern_bucket_count * sizeof(*intern_buckets));
+    if (series_slots == NULL || series_buckets == NULL || intern_slots == NULL || intern_buckets == NULL)
+    {
+        perror("Error al reservar la tabla de series");
+        return -1;
+    }
+
+    // Todas las estructuras se enlazan por índice, así que se inicializan con NONE
+    memset(series_buckets, 0xff, series_bucket_count * sizeof(*series_buckets));
+    memset(intern_buckets, 0xff, intern_bucket_count * sizeof(*intern_buckets));
+    for (size_t i = 0; i < capacity; i++)
+    {
+        series_slots[i].hash_next = i + 1 < capacity ? (uint32_t)(i + 1) : NONE;
+    }
+    for (size_t i = 0; i < intern_capacity; i++)
+    {
+        intern_slots[i].hash_next = i + 1 < intern_capacity ? (uint32_t)(i + 1) : NONE;
+    }
+
+    series_bucket_mask = series_bucket_count - 1;
+    intern_bucket_mask = intern_bucket_count - 1;
+    series_free = 0;
+    intern_free = 0;
+    stats.capacity = capacity;
+    stats.last_evicted_family = -1;
+    return 0;
+}
+
+int series_family_new(const char* name, const char* help, enum series_type type, size_t label_count,
+                      const char** label_keys)
+{
+    if (family_count == SERIES_MAX_FAMILIES || label_count > SERIES_MAX_LABELS || strlen(name) >= FAMILY_NAME_SIZE ||
+        strlen(help) >= FAMILY_HELP_SIZE)
+    {
+        fprintf(stderr, "No se pudo registrar la familia %s\n", name);
+        return -1;
+    }
+
+    // Los contadores terminan en _total en todos los formatos: OpenMetrics lo agrega a cada muestra
+    // y sin el sufijo el texto y protobuf expondrían otro nombre
+    size_t name_len = strlen(name);
+    if (type == SERIES_COUNTER && (name_len <= strlen(COUNTER_SUFFIX) ||
+                                   strcmp(name + name_len - strlen(COUNTER_SUFFIX), COUNTER_SUFFIX) != 0))
+    {
+        fprintf(stderr, "El contador %s debe terminar en %s\n", name, COUNTER_SUFFIX);
+        return -1;
+    }
+
+    struct family* fam = &families[family_count];
+    strcpy(fam->name, name);
+    strcpy(fam->help, help);
+    fam->type = type;
+    fam->label_count = label_count;
+    for (size_t i = 0; i < label_count; i++)
+    {
+        if (strlen(label_keys[i]) >= SERIES_LABEL_SIZE)
+        {
+            fprintf(stderr, "Etiqueta demasiado larga en la familia %s\n", name);
+            return -1;
+        }
+        strcpy(fam->label_keys[i], label_keys[i]);
+    }
+    fam->generation = 0;
+    fam->head = fam->tail = NONE;
+    fam->created = 0.0;
+    fam->exemplar_series = NONE;
+    fam->hook = NULL;
+    fam->self = false;
+
+    return (int)family_count++;
+}
+
+void series_family_set_created(int family, double created)
+{
+    if (family >= 0 && (size_t)family < family_count)
+    {
+        families[family].created = created;
+    }
+}
+
+void series_family_set_self(int family)
+{
+    if (family >= 0 && (size_t)family < family_count)
+    {
+        families[family].self = true;
+    }
+}
+
+const char* series_family_name(int family)
+{
+    if (family < 0 || (size_t)family >= family_count)
+    {
+        return NULL;
+    }
+    return families[family].name;
+}
+
+int series_family_find(const char* name)
+{
+    for (size_t f = 0; f < family_count; f++)
+    {
+        if (strcmp(families[f].name, name) == 0)
+        {
+            return (int)f;
+        }
+    }
+    return -1;
+}
+
+size_t series_family_label_keys(int family, const char** keys)
+{
+    if (family < 0 || (size_t)family >= family_count)
+    {
+        return 0;
+    }
+    for (size_t i = 0; i < families[family].label_count; i++)
+    {
+        keys[i] = families[family].label_keys[i];
+    }
+    return families[family].label_count;
+}
+
+void series_family_set_hook(int family, series_sample_hook hook)
+{
+    if (family >= 0 && (size_t)family < family_count)
+    {
+        families[family].hook = hook;
+    }
+}
+
+/**
+ * @brief Busca una serie existente por sus valores de etiquetas.
+ *
+ * @return Índice de la serie, o NONE si no existe.
+ */
+static uint32_t find_series(int family, const char** label_values)
+{
+    const struct family* fam = &families[family];
+    uint32_t labels[SERIES_MAX_LABELS];
+
+    // Si alguna etiqueta no está internada, la serie no puede existir todavía
+    for (size_t i = 0; i < fam->label_count; i++)
+    {
+        labels[i] = intern_find(label_values[i], hash_string(label_values[i]));
+        if (labels[i] == NONE)
+        {
+            return NONE;
+        }
+    }
+
+    uint32_t bucket = hash_series(family, labels, fam->label_count) & series_bucket_mask;
+    for (uint32_t idx = series_buckets[bucket]; idx != NONE; idx = series_slots[idx].hash_next)
+    {
+        if (series_slots[idx].family == family &&
+            memcmp(series_slots[idx].labels, labels, fam->label_count * sizeof(uint32_t)) == 0)
+        {
+            return idx;
+        }
+    }
+    return NONE;
+}
+
+int series_set(int family, const char** label_values, double value)
+{
+    if (family < 0 || (size_t)family >= family_count || series_slots == NULL)
+    {
+        return -1;
+    }
+
+    struct family* fam = &families[family];
+    for (size_t i = 0; i < fam->label_count; i++)
+    {
+        if (strlen(label_values[i]) >= SERIES_LABEL_SIZE)
+        {
+            fprintf(stderr, "Valor de etiqueta demasiado largo en %s: %s\n", fam->name, label_values[i]);
+            return -1;
+        }
+    }
+
+    uint32_t idx = find_series(family, label_values);
+    if (idx == NONE)
+    {
+        idx = create_series(family, label_values);
+        if (idx == NONE)
+        {
+            return -1;
+        }
+    }
+
+    struct series* s = &series_slots[idx];
+    if (s->state == SERIES_STALE)
+    {
+        s->state = SERIES_ACTIVE;
+        stats.stale--;
+        stats.active++;
+        version++;
+    }
+
+    // Los valores que no cambian no invalidan las exposiciones generadas; NaN se compara consigo mismo.
+    // Los de la contabilidad del agente, que cambian en cada ciclo, sólo invalidan su propia parte
+    if (s->value != value && !(isnan(s->value) && isnan(value)))
+    {
+        s->value = value;
+        if (fam->self)
+        {
+            self_version++;
+        }
+        else
+        {
+            version++;
+        }
+    }
+    s->generation = fam->generation;
+    if (fam->label_count > 0 && lru_head != idx)
+    {
+        lru_unlink(idx);
+        lru_push_front(idx);
+    }
+
+    if (fam->hook != NULL)
+    {
+        fam->hook(family, label_values, value);
+    }
+    return 0;
+}
+
+int series_set_exemplar(int family, const char** label_values, const char* key, const char* value, double sample)
+{
+    if (family < 0 || (size_t)family >= family_count || series_slots == NULL)
+    {
+        return -1;
+    }
+
+    uint32_t idx = find_series(family, label_values);
+    if (idx == NONE)
+    {
+        return -1;
+    }
+
+    struct family* fam = &families[family];
+    fam->exemplar_series = idx;
+    snprintf(fam->exemplar_key, sizeof(fam->exemplar_key), "%s", key);
+    snprintf(fam->exemplar_value, sizeof(fam->exemplar_value), "%s", value);
+    fam->exemplar_sample = sample;
+    fam->exemplar_time = now_seconds();
+    version++;
+    return 0;
+}
+
+void series_sweep_begin(int family)
+{
+    if (family >= 0 && (size_t)family < family_count)
+    {
+        families[family].generation++;
+    }
+}
+
+void series_sweep_end(int family)
+{
+    if (family < 0 || (size_t)family >= family_count)
+    {
+        return;
+    }
+
+    struct family* fam = &families[family];
+    for (uint32_t idx = fam->head; idx != NONE; idx = series_slots[idx].family_next)
+    {
+        struct series* s = &series_slots[idx];
+        if (s->state == SERIES_ACTIVE && s->generation != fam->generation)
+        {
+            s->state = SERIES_STALE;
+            stats.active--;
+            stats.stale++;
+            stats.staled++;
+            version++;
+
+            if (fam->hook != NULL)
+            {
+                const char* label_values[SERIES_MAX_LABELS];
+                for (size_t i = 0; i < fam->label_count; i++)
+                {
+                    label_values[i] = intern_slots[s->labels[i]].value;
+                }
+                fam->hook(family, label_values, NAN);
+            }
+        }
+    }
+}
+
+void series_get_stats(struct series_stats* out)
+{
+    *out = stats;
+}
+
+unsigned long long series_version(void)
+{
+    return version;
+}
+
+unsigned long long series_self_version(void)
+{
+    return self_version;
+}
+
+/**
+ * @brief Asegura que el buffer tenga lugar para extra bytes más el terminador.
+ */
+static int buffer_reserve(struct series_buffer* buffer, size_t extra)
+{
+    size_t needed = buffer->len + extra + 1;
+    if (needed <= buffer->capacity)
+    {
+        return 0;
+    }
+
+    size_t new_capacity = buffer->capacity == 0 ? BUFFER_INITIAL_SIZE : buffer->capacity;
+    while (new_capacity < needed)
+    {
+        new_capacity *= 2;
+    }
+
+    char* new_data = realloc(buffer->data, new_capacity);
+    if (new_data == NULL)
+    {
+        perror("Error al reservar el buffer de exposición");
+        return -1;
+    }
+    buffer->data = new_data;
+    buffer->capacity = new_capacity;
+    return 0;
+}
+
+static int buffer_append(struct series_buffer* buffer, const char* data, size_t len)
+{
+    if (buffer_reserve(buffer, len) != 0)
+    {
+        return -1;
+    }
+    memcpy(buffer->data + buffer->len, data, len);
+    buffer->len += len;
+    buffer->data[buffer->len] = '\0';
+    return 0;
+}
+
+static int buffer_append_str(struct series_buffer* buffer, const char* str)
+{
+    return buffer_append(buffer, str, strlen(str));
+}
+
+int series_buffer_copy(struct series_buffer* buffer, const struct series_buffer* source)
+{
+    buffer->len = 0;
+    return buffer_append(buffer, source->data != NULL ? source->data : "", source->len);
+}
+
+/**
+ * @brief Prepara el buffer para una parte de la exposición: la vacía, salvo SERIES_PART_SELF, que se agrega.
+ */
+static int buffer_begin_part(struct series_buffer* buffer, enum series_part part)
+{
+    if (part != SERIES_PART_SELF)
+    {
+        buffer->len = 0;
+    }
+    if (buffer_reserve(buffer, 0) != 0)
+    {
+        return -1;
+    }
+    buffer->data[buffer->len] = '\0';
+    return 0;
+}
+
+/**
+ * @brief Indica si una familia pertenece a la parte de la exposición que se está escribiendo.
+ */
+static bool part_includes(const struct family* fam, enum series_part part)
+{
+    if (part == SERIES_PART_ALL)
+    {
+        return true;
+    }
+    return fam->self == (part == SERIES_PART_SELF);
+}
+
+/**
+ * @brief Agrega un valor de etiqueta escapando '\\', '"' y saltos de línea.
+ */
+static int buffer_append_label_value(struct series_buffer* buffer, const char* value)
+{
+    for (; *value != '\0'; value++)
+    {
+        int ret;
+        switch (*value)
+        {
+        case '\\':
+            ret = buffer_append(buffer, "\\\\", 2);
+            break;
+        case '"':
+            ret = buffer_append(buffer, "\\\"", 2);
+            break;
+        case '\n':
+            ret = buffer_append(buffer, "\\n", 2);
+            break;
+        default:
+            ret = buffer_append(buffer, value, 1);
+            break;
+        }
+        if (ret != 0)
+        {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief Agrega un valor numérico con la representación más corta que lo reproduce exactamente.
+ */
+static int buffer_append_value(struct series_buffer* buffer, double value)
+{
+    char text[32];
+
+    if (isnan(value))
+    {
+        return buffer_append_str(buffer, "NaN");
+    }
+    if (isinf(value))
+    {
+        return buffer_append_str(buffer, value > 0 ? "+Inf" : "-Inf");
+    }
+
+    snprintf(text, sizeof(text), "%.15g", value);
+    if (strtod(text, NULL) != value)
+    {
+        snprintf(text, sizeof(text), "%.17g", value);
+    }
+    return buffer_append_str(buffer, text);
+}
+
+/**
+ * @brief Agrega el conjunto de etiquetas de una serie, con llaves sólo si tiene etiquetas.
+ */
+static int buffer_append_labels(struct series_buffer* buffer, const struct family* fam, const struct series* s)
+{
+    int ret = 0;
+    for (size_t i = 0; i < fam->label_count; i++)
+    {
+        ret |= buffer_append_str(buffer, i == 0 ? "{" : ",");
+        ret |= buffer_append_str(buffer, fam->label_keys[i]);
+        ret |= buffer_append_str(buffer, "=\"");
+        ret |= buffer_append_label_value(buffer, intern_slots[s->labels[i]].value);
+        ret |= buffer_append_str(buffer, "\"");
+    }
+    if (fam->label_count > 0)
+    {
+        ret |= buffer_append_str(buffer, "}");
+    }
+    return ret;
+}
+
+int series_render_text(struct series_buffer* buffer, enum series_part part)
+{
+    static const char* const TYPE_NAMES[] = {"gauge", "counter"};
+
+    if (buffer_begin_part(buffer, part) != 0)
+    {
+        return -1;
+    }
+
+    for (size_t f = 0; f < family_count; f++)
+    {
+        const struct family* fam = &families[f];
+        if (!part_includes(fam, part))
+        {
+            continue;
+        }
+        bool header_written = false;
+
+        for (uint32_t idx = fam->head; idx != NONE; idx = series_slots[idx].family_next)
+        {
+            const struct series* s = &series_slots[idx];
+            if (s->state != SERIES_ACTIVE)
+            {
+                continue;
+            }
+
+            int ret = 0;
+            if (!header_written)
+            {
+                ret |= buffer_append_str(buffer, "# HELP ");
+                ret |= buffer_append_str(buffer, fam->name);
+                ret |= buffer_append_str(buffer, " ");
+                ret |= buffer_append_str(buffer, fam->help);
+                ret |= buffer_append_str(buffer, "\n# TYPE ");
+                ret |= buffer_append_str(buffer, fam->name);
+                ret |= buffer_append_str(buffer, " ");
+                ret |= buffer_append_str(buffer, TYPE_NAMES[fam->type]);
+                ret |= buffer_append_str(buffer, "\n");
+                header_written = true;
+            }
+
+            ret |= buffer_append_str(buffer, fam->name);
+            ret |= buffer_append_labels(buffer, fam, s);
+            ret |= buffer_append_str(buffer, " ");
+            ret |= buffer_append_value(buffer, s->value);
+            ret |= buffer_append_str(buffer, "\n");
+
+            if (ret != 0)
+            {
+                return -1;
+            }
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Agrega un momento en segundos desde la época con precisión de milisegundos.
+ */
+static int buffer_append_timestamp(struct series_buffer* buffer, double timestamp)
+{
+    char text[32];
+    snprintf(text, sizeof(text), "%.3f", timestamp);
+    return buffer_append_str(buffer, text);
+}
+
+/**
+ * @brief Longitud del nombre de la familia en OpenMetrics: los contadores no llevan el sufijo _total.
+ */
+static size_t openmetrics_name_len(const struct family* fam)
+{
+    size_t len = strlen(fam->name);
+    if (fam->type == SERIES_COUNTER)
+    {
+        return len - strlen(COUNTER_SUFFIX);
+    }
+    return len;
+}
+
+int series_render_openmetrics(struct series_buffer* buffer, enum series_part part)
+{
+    static const char* const TYPE_NAMES[] = {"gauge", "counter"};
+
+    if (buffer_begin_part(buffer, part) != 0)
+    {
+        return -1;
+    }
+
+    for (size_t f = 0; f < family_count; f++)
+    {
+        const struct family* fam = &families[f];
+        if (!part_includes(fam, part))
+        {
+            continue;
+        }
+        size_t name_len = openmetrics_name_len(fam);
+        bool header_written = false;
+
+        for (uint32_t idx = fam->head; idx != NONE; idx = series_slots[idx].family_next)
+        {
+            const struct series* s = &series_slots[idx];
+            if (s->state != SERIES_ACTIVE)
+            {
+                continue;
+            }
+
+            int ret = 0;
+            if (!header_written)
+            {
+                ret |= buffer_append_str(buffer, "# TYPE ");
+                ret |= buffer_append(buffer, fam->name, name_len);
+                ret |= buffer_append_str(buffer, " ");
+                ret |= buffer_append_str(buffer, TYPE_NAMES[fam->type]);
+                ret |= buffer_append_str(buffer, "\n# HELP ");
+                ret |= buffer_append(buffer, fam->name, name_len);
+                ret |= buffer_append_str(buffer, " ");
+                ret |= buffer_append_label_value(buffer, fam->help);
+                ret |= buffer_append_str(buffer, "\n");
+                header_written = true;
+            }
+
+            ret |= buffer_append(buffer, fam->name, name_len);
+            if (fam->type == SERIES_COUNTER)
+            {
+                ret |= buffer_append_str(buffer, COUNTER_SUFFIX);
+            }
+            ret |= buffer_append_labels(buffer, fam, s);
+            ret |= buffer_append_str(buffer, " ");
+            ret |= buffer_append_value(buffer, s->value);
+
+            if (fam->type == SERIES_COUNTER)
+            {
+                if (fam->exemplar_series == idx)
+                {
+                    ret |= buffer_append_str(buffer, " # {");
+                    ret |= buffer_append_str(buffer, fam->exemplar_key);
+                    ret |= buffer_append_str(buffer, "=\"");
+                    ret |= buffer_append_label_value(buffer, fam->exemplar_value);
+                    ret |= buffer_append_str(buffer, "\"} ");
+                    ret |= buffer_append_value(buffer, fam->exemplar_sample);
+                    ret |= buffer_append_str(buffer, " ");
+                    ret |= buffer_append_timestamp(buffer, fam->exemplar_time);
+                }
+                ret |= buffer_append_str(buffer, "\n");
+                ret |= buffer_append(buffer, fam->name, name_len);
+                ret |= buffer_append_str(buffer, "_created");
+                ret |= buffer_append_labels(buffer, fam, s);
+                ret |= buffer_append_str(buffer, " ");
+                ret |= buffer_append_timestamp(buffer, s->created);
+            }
+            ret |= buffer_append_str(buffer, "\n");
+
+            if (ret != 0)
+            {
+                return -1;
+            }
+        }
+    }
+
+    return part == SERIES_PART_OBSERVED ? 0 : buffer_append_str(buffer, "# EOF\n");
+}
+
+/**
+ * Codificación protobuf de io.prometheus.client (metrics.proto). Sólo se usan los campos que la
+ * tabla puede producir; los números de campo son los del esquema.
+ */
+#define PB_WIRE_VARINT 0
+#define PB_WIRE_FIXED64 1
+#define PB_WIRE_LENGTH 2
+
+#define PB_FAMILY_NAME 1
+#define PB_FAMILY_HELP 2
+#define PB_FAMILY_TYPE 3
+#define PB_FAMILY_METRIC 4
+#define PB_METRIC_LABEL 1
+#define PB_METRIC_GAUGE 2
+#define PB_METRIC_COUNTER 3
+#define PB_LABEL_NAME 1
+#define PB_LABEL_VALUE 2
+#define PB_VALUE 1
+#define PB_COUNTER_EXEMPLAR 2
+#define PB_COUNTER_CREATED 3
+#define PB_EXEMPLAR_LABEL 1
+#define PB_EXEMPLAR_VALUE 2
+#define PB_EXEMPLAR_TIMESTAMP 3
+#define PB_TIMESTAMP_SECONDS 1
+#define PB_TIMESTAMP_NANOS 2
+
+/** Valores de io.prometheus.client.MetricType, indexados por enum series_type */
+static const uint64_t PB_TYPES[] = {1 /* GAUGE */, 0 /* COUNTER */};
+
+/** Bytes máximos de un varint de 64 bits */
+#define PB_VARINT_MAX 10
+
+static size_t pb_encode_varint(uint8_t* out, uint64_t value)
+{
+    size_t len = 0;
+    while (value >= 0x80)
+    {
+        out[len++] = (uint8_t)(value | 0x80);
+        value >>= 7;
+    }
+    out[len++] = (uint8_t)value;
+    return len;
+}
+
+static int pb_varint(struct series_buffer* buffer, uint64_t value)
+{
+    uint8_t encoded[PB_VARINT_MAX];
+    return buffer_append(buffer, (const char*)encoded, pb_encode_varint(encoded, value));
+}
+
+static int pb_tag(struct series_buffer* buffer, unsigned int field, unsigned int wire_type)
+{
+    return pb_varint(buffer, (uint64_t)field << 3 | wire_type);
+}
+
+static int pb_uint(struct series_buffer* buffer, unsigned int field, uint64_t value)
+{
+    return pb_tag(buffer, field, PB_WIRE_VARINT) | pb_varint(buffer, value);
+}
+
+static int pb_string(struct series_buffer* buffer, unsigned int field, const char* value)
+{
+    size_t len = strlen(value);
+    return pb_tag(buffer, field, PB_WIRE_LENGTH) | pb_varint(buffer, len) | buffer_append(buffer, value, len);
+}
+
+static int pb_double(struct series_buffer* buffer, unsigned int field, double value)
+{
+    uint64_t bits;
+    char encoded[8];
+    memcpy(&bits, &value, sizeof(bits));
+    for (int i = 0; i < 8; i++)
+    {
+        encoded[i] = (char)(bits >> (8 * i));
+    }
+    return pb_tag(buffer, field, PB_WIRE_FIXED64) | buffer_append(buffer, encoded, sizeof(encoded));
+}
+
+/**
+ * @brief Termina un mensaje que comienza en start insertando su longitud delante.
+ *
+ * Los mensajes se escriben antes de conocer su tamaño; al terminarlos se desplaza el contenido
+ * para dejar lugar al varint, que casi siempre ocupa uno o dos bytes.
+ */
+static int pb_end(struct series_buffer* buffer, size_t start)
+{
+    uint8_t encoded[PB_VARINT_MAX];
+    size_t body = buffer->len - start;
+    size_t prefix = pb_encode_varint(encoded, body);
+    if (buffer_reserve(buffer, prefix) != 0)
+    {
+        return -1;
+    }
+    memmove(buffer->data + start + prefix, buffer->data + start, body);
+    memcpy(buffer->data + start, encoded, prefix);
+    buffer->len += prefix;
+    buffer->data[buffer->len] = '\0';
+    return 0;
+}
+
+/**
+ * @brief Comienza un mensaje anidado en un campo; devuelve en start dónde termina pb_end().
+ */
+static int pb_begin(struct series_buffer* buffer, unsigned int field, size_t* start)
+{
+    int ret = pb_tag(buffer, field, PB_WIRE_LENGTH);
+    *start = buffer->len;
+    return ret;
+}
+
+static int pb_label_pair(struct series_buffer* buffer, unsigned int field, const char* name, const char* value)
+{
+    size_t start;
+    int ret = pb_begin(buffer, field, &start);
+    ret |= pb_string(buffer, PB_LABEL_NAME, name);
+    ret |= pb_string(buffer, PB_LABEL_VALUE, value);
+    return ret | pb_end(buffer, start);
+}
+
+static int pb_timestamp(struct series_buffer* buffer, unsigned int field, double timestamp)
+{
+    size_t start;
+    double seconds = floor(timestamp);
+    int ret = pb_begin(buffer, field, &start);
+    ret |= pb_uint(buffer, PB_TIMESTAMP_SECONDS, (uint64_t)seconds);
+    ret |= pb_uint(buffer, PB_TIMESTAMP_NANOS, (uint64_t)((timestamp - seconds) * 1e9));
+    return ret | pb_end(buffer, start);
+}
+
+/**
+ * @brief Codifica un io.prometheus.client.Metric con sus etiquetas y su valor.
+ */
+static int pb_metric(struct series_buffer* buffer, const struct family* fam, uint32_t idx)
+{
+    const struct series* s = &series_slots[idx];
+    size_t metric_start, value_start;
+    int ret = pb_begin(buffer, PB_FAMILY_METRIC, &metric_start);
+
+    for (size_t i = 0; i < fam->label_count; i++)
+    {
+        ret |= pb_label_pair(buffer, PB_METRIC_LABEL, fam->label_keys[i], intern_slots[s->labels[i]].value);
+    }
+
+    if (fam->type == SERIES_COUNTER)
+    {
+        ret |= pb_begin(buffer, PB_METRIC_COUNTER, &value_start);
+        ret |= pb_double(buffer, PB_VALUE, s->value);
+        if (fam->exemplar_series == idx)
+        {
+            size_t exemplar_start;
+            ret |= pb_begin(buffer, PB_COUNTER_EXEMPLAR, &exemplar_start);
+            ret |= pb_label_pair(buffer, PB_EXEMPLAR_LABEL, fam->exemplar_key, fam->exemplar_value);
+            ret |= pb_double(buffer, PB_EXEMPLAR_VALUE, fam->exemplar_sample);
+            ret |= pb_timestamp(buffer, PB_EXEMPLAR_TIMESTAMP, fam->exemplar_time);
+            ret |= pb_end(buffer, exemplar_start);
+        }
+        ret |= pb_timestamp(buffer, PB_COUNTER_CREATED, s->created);
+    }
+    else
+    {
+        ret |= pb_begin(buffer, PB_METRIC_GAUGE, &value_start);
+        ret |= pb_double(buffer, PB_VALUE, s->value);
+    }
+    ret |= pb_end(buffer, value_start);
+
+    return ret | pb_end(buffer, metric_start);
+}
+
+int series_render_protobuf(struct series_buffer* buffer, enum series_part part)
+{
+    if (buffer_begin_part(buffer, part) != 0)
+    {
+        return -1;
+    }
+
+    for (size_t f = 0; f < family_count; f++)
+    {
+        const struct family* fam = &families[f];
+        if (!part_includes(fam, part))
+        {
+            continue;
+        }
+        bool header_written = false;
+        size_t family_start = 0;
+
+        for (uint32_t idx = fam->head; idx != NONE; idx = series_slots[idx].family_next)
+        {
+            if (series_slots[idx].state != SERIES_ACTIVE)
+            {
+                continue;
+            }
+
+            int ret = 0;
+            if (!header_written)
+            {
+                // Cada MetricFamily va precedida de su longitud, sin número de campo
+                family_start = buffer->len;
+                ret |= pb_string(buffer, PB_FAMILY_NAME, fam->name);
+                ret |= pb_string(buffer, PB_FAMILY_HELP, fam->help);
+                ret |= pb_uint(buffer, PB_FAMILY_TYPE, PB_TYPES[fam->type]);
+                header_written = true;
+            }
+            ret |= pb_metric(buffer, fam, idx);
+
+            if (ret != 0)
+            {
+                return -1;
+            }
+        }
+
+        if (header_written && pb_end(buffer, family_start) != 0)
+        {
+            return -1;
+        }
+    }
+
+    return 0;
+}
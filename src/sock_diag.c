@@ -0,0 +1,207 @@
+#include "../include/sock_diag.h"
+#include "../include/proc_source.h"
+#include <errno.h>
+#include <linux/inet_diag.h>
+#include <linux/netlink.h>
+#include <linux/sock_diag.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+/** Tamaño del buffer de recepción; el kernel agrupa varios inet_diag_msg por datagrama. */
+#define NETLINK_BUFFER_SIZE (32 * 1024)
+
+/** Nombres de los estados TCP en el orden de include/net/tcp_states.h. */
+static const char* const SOCK_STATE_NAMES[SOCK_STATE_COUNT] = {
+    "unknown",    "established", "syn_sent", "syn_recv",  "fin_wait1", "fin_wait2",    "time_wait",
+    "close",      "close_wait",  "last_ack", "listen",    "closing",   "new_syn_recv",
+};
+
+const char* sock_state_name(int state)
+{
+    if (state <= 0 || state >= SOCK_STATE_COUNT)
+    {
+        return SOCK_STATE_NAMES[0];
+    }
+    return SOCK_STATE_NAMES[state];
+}
+
+const char* sock_udp_state_name(int state)
+{
+    if (state == SOCK_STATE_ESTABLISHED)
+    {
+        return "connected";
+    }
+    if (state == SOCK_STATE_CLOSE)
+    {
+        return "unconnected";
+    }
+    return NULL;
+}
+
+long long sock_queue_bucket_bound(int bucket)
+{
+    if (bucket >= SOCK_QUEUE_BUCKETS - 1)
+    {
+        return -1;
+    }
+    return (1LL << bucket) - 1;
+}
+
+/**
+ * @brief Calcula el bucket del histograma que corresponde a un tamaño de cola.
+ *
+ * @param queue Bytes en la cola.
+ * @return Índice del bucket.
+ */
+static int queue_bucket(unsigned int queue)
+{
+    if (queue == 0)
+    {
+        return 0;
+    }
+
+    // Posición del bit más significativo + 1
+    int bucket = 32 - __builtin_clz(queue);
+    return bucket < SOCK_QUEUE_BUCKETS - 1 ? bucket : SOCK_QUEUE_BUCKETS - 1;
+}
+
+/**
+ * @brief Agrega en el histograma los mensajes netlink de un buffer de respuesta.
+ *
+ * @param data Mensajes netlink recibidos (uno o más datagramas concatenados).
+ * @param len Cantidad de bytes en data.
+ * @param hist Histograma donde se acumulan los sockets.
+ * @return 1 si se encontró NLMSG_DONE, 0 si faltan mensajes, o -1 en caso de error.
+ */
+static int aggregate_messages(const char* data, size_t len, struct sock_histogram* hist)
+{
+    int remaining = (int)len;
+    const struct nlmsghdr* nlh = (const struct nlmsghdr*)data;
+
+    for (; NLMSG_OK(nlh, remaining); nlh = NLMSG_NEXT(nlh, remaining))
+    {
+        if (nlh->nlmsg_type == NLMSG_DONE)
+        {
+            return 1;
+        }
+        if (nlh->nlmsg_type == NLMSG_ERROR)
+        {
+            const struct nlmsgerr* err = (const struct nlmsgerr*)NLMSG_DATA(nlh);
+            // EAFNOSUPPORT/ENOENT: la familia o el protocolo no están disponibles (p. ej. sin IPv6)
+            if (err->error == -ENOENT || err->error == -EAFNOSUPPORT)
+            {
+                return 1;
+            }
+            fprintf(stderr, "Error INET_DIAG: %s\n", strerror(-err->error));
+            return -1;
+        }
+
+        const struct inet_diag_msg* msg = (const struct inet_diag_msg*)NLMSG_DATA(nlh);
+        int state = msg->idiag_state < SOCK_STATE_COUNT ? msg->idiag_state : 0;
+        hist->total++;
+        hist->by_state[state]++;
+        if (state == SOCK_STATE_LISTEN)
+        {
+            hist->accept_queue[queue_bucket(msg->idiag_rqueue)]++;
+            continue;
+        }
+        hist->recv_queue[queue_bucket(msg->idiag_rqueue)]++;
+        hist->send_queue[queue_bucket(msg->idiag_wqueue)]++;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Realiza un volcado INET_DIAG de una familia y lo agrega en el histograma.
+ *
+ * En modo grabación los datagramas recibidos se guardan tal cual en la captura; en modo
+ * reproducción se agregan los datagramas grabados en lugar de consultar al kernel.
+ *
+ * @param family AF_INET o AF_INET6.
+ * @param protocol IPPROTO_TCP o IPPROTO_UDP.
+ * @param hist Histograma donde se acumulan los sockets.
+ * @return 0 en caso de éxito, o -1 en caso de error.
+ */
+static int dump_family(int family, int protocol, struct sock_histogram* hist)
+{
+    static char buffer[NETLINK_BUFFER_SIZE] __attribute__((aligned(NLMSG_ALIGNTO)));
+
+    char capture_name[64];
+    snprintf(capture_name, sizeof(capture_name), "netlink:inet_diag:%d:%d", family, protocol);
+
+    if (proc_source_mode() == PROC_SOURCE_REPLAY)
+    {
+        size_t len;
+        const char* data = proc_source_lookup(capture_name, &len);
+        if (data == NULL)
+        {
+            return -1;
+        }
+        return aggregate_messages(data, len, hist) < 0 ? -1 : 0;
+    }
+
+    int fd = socket(AF_NETLINK, SOCK_DGRAM | SOCK_CLOEXEC, NETLINK_SOCK_DIAG);
+    if (fd < 0)
+    {
+        perror("Error al abrir el socket NETLINK_SOCK_DIAG");
+        return -1;
+    }
+
+    struct
+    {
+        struct nlmsghdr nlh;
+        struct inet_diag_req_v2 req;
+    } request;
+
+    memset(&request, 0, sizeof(request));
+    request.nlh.nlmsg_len = sizeof(request);
+    request.nlh.nlmsg_type = SOCK_DIAG_BY_FAMILY;
+    request.nlh.nlmsg_flags = NLM_F_REQUEST | NLM_F_DUMP;
+    request.req.sdiag_family = family;
+    request.req.sdiag_protocol = protocol;
+    request.req.idiag_states = ~0U; // Todos los estados
+
+    struct sockaddr_nl kernel = {.nl_family = AF_NETLINK};
+    if (sendto(fd, &request, sizeof(request), 0, (struct sockaddr*)&kernel, sizeof(kernel)) < 0)
+    {
+        perror("Error al enviar la petición INET_DIAG");
+        close(fd);
+        return -1;
+    }
+
+    int ret = 0;
+    while (ret == 0)
+    {
+        ssize_t len = recv(fd, buffer, sizeof(buffer), 0);
+        if (len < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            perror("Error al recibir la respuesta INET_DIAG");
+            ret = -1;
+            break;
+        }
+
+        proc_source_append(capture_name, buffer, len);
+        ret = aggregate_messages(buffer, len, hist);
+    }
+
+    close(fd);
+    return ret < 0 ? -1 : 0;
+}
+
+int get_socket_histogram(int protocol, struct sock_histogram* hist)
+{
+    memset(hist, 0, sizeof(*hist));
+
+    if (dump_family(AF_INET, protocol, hist) != 0)
+    {
+        return -1;
+    }
+    return dump_family(AF_INET6, protocol, hist);
+}